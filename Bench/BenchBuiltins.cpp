@@ -0,0 +1,42 @@
+// Cost of trivial commands as native builtins versus spawning a shell
+#include "BenchUtil.h"
+#include "ClaudeConsole.h"
+#include "ProcessExecutor.h"
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+
+using namespace cll;
+using namespace cll::bench;
+
+namespace {
+
+std::string RunPopen(const std::string& command) {
+    std::string output;
+    FILE* pipe = popen(command.c_str(), "r");
+    char buffer[256];
+    while (fgets(buffer, sizeof(buffer), pipe)) {
+        output += buffer;
+    }
+    pclose(pipe);
+    return output;
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    int iterations = argc > 1 ? std::atoi(argv[1]) : 2000;
+    ClaudeConsole console;
+    console.Initialize();
+    ProcessExecutor executor;
+
+    for (const std::string command : {"pwd", "echo hello world", "which sh", "cd ."}) {
+        PrintHeader(std::to_string(iterations) + " x '" + command + "'");
+        PrintRow("popen", MeanMicros(iterations, [&] { RunPopen(command); }), "us/cmd");
+        PrintRow("sh -c via ProcessExecutor", MeanMicros(iterations, [&] { executor.ExecuteShell(command); }), "us/cmd");
+        PrintRow("native builtin", MeanMicros(iterations, [&] { console.ExecuteShellCommand(command); }), "us/cmd");
+    }
+
+    console.Shutdown();
+    return 0;
+}
@@ -0,0 +1,68 @@
+// Bulk output capture versus line-at-a-time popen loops
+#include "BenchUtil.h"
+#include "ProcessExecutor.h"
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <sys/resource.h>
+
+using namespace cll;
+using namespace cll::bench;
+
+namespace {
+
+// How output used to be captured: fgets into a small stack buffer. It
+// stops at the first NUL of each read, so binary output is cut short.
+size_t CapturePopen(const std::string& command, size_t lineBuffer) {
+    std::string output;
+    FILE* pipe = popen(command.c_str(), "r");
+    std::string buffer(lineBuffer, '\0');
+    while (fgets(buffer.data(), static_cast<int>(buffer.size()), pipe)) {
+        output += buffer.c_str();
+    }
+    pclose(pipe);
+    return output.size();
+}
+
+double ProcessCpuSeconds() {
+    rusage usage{};
+    getrusage(RUSAGE_SELF, &usage);
+    auto seconds = [](const timeval& tv) { return tv.tv_sec + tv.tv_usec / 1e6; };
+    return seconds(usage.ru_utime) + seconds(usage.ru_stime);
+}
+
+// Best of a few runs, in wall time and in this process's CPU time (the
+// capturing side alone, without the producer)
+void Measure(const std::string& label, size_t expected, const std::function<size_t()>& capture) {
+    double bestWall = 1e9, bestCpu = 1e9;
+    size_t captured = 0;
+    for (int i = 0; i < 3; ++i) {
+        double cpu = ProcessCpuSeconds();
+        bestWall = std::min(bestWall, Seconds([&] { captured = capture(); }));
+        bestCpu = std::min(bestCpu, ProcessCpuSeconds() - cpu);
+    }
+    PrintRow(label + " wall", bestWall, "s");
+    PrintRow(label + " capturing cpu", bestCpu, "s");
+    if (captured != expected) std::printf("  (captured %zu bytes)\n", captured);
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    size_t bytes = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 1000000000;
+    ProcessExecutor executor;
+    executor.StartServer();
+
+    // Text, so the fgets loops see every byte
+    std::string command = "yes abcdefghijklmnopqrstuvwxyz0123456789 | head -c " + std::to_string(bytes);
+    PrintHeader(std::to_string(bytes) + " bytes from '" + command + "'");
+    for (size_t lineBuffer : {128, 256, 4096}) {
+        Measure("popen + fgets(" + std::to_string(lineBuffer) + ")", bytes,
+                [&] { return CapturePopen(command, lineBuffer); });
+    }
+    Measure("ProcessExecutor", bytes, [&] { return executor.ExecuteShell(command).output.size(); });
+
+    executor.StopServer();
+    return 0;
+}
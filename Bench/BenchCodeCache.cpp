@@ -0,0 +1,75 @@
+// Cold-start load() of a large script, compiled from source and from the code cache
+#include "BenchUtil.h"
+#include "ClaudeConsole.h"
+#include <cstdlib>
+#include <filesystem>
+#include <format>
+#include <fstream>
+#include <unistd.h>
+
+using namespace cll;
+using namespace cll::bench;
+namespace fs = std::filesystem;
+
+namespace {
+
+// A bundle of small functions, roughly the size asked for
+std::string MakeBundle(size_t bytes) {
+    std::string source;
+    for (size_t i = 0; source.size() < bytes; ++i) {
+        source += std::format("function helper{0}(a, b) {{ const t = [a, b, {0}]; "
+                              "return t.map(x => x * 2).reduce((s, x) => s + x, 0); }}\n", i);
+    }
+    source += "var loaded = true;\n";
+    return source;
+}
+
+struct LoadReport {
+    double micros = -1;
+    CodeCache::Stats stats;
+};
+
+// Each load runs in a fresh process, as a new session would, since V8
+// also caches compiled scripts in memory for the life of the isolate
+LoadReport LoadInChild(const std::string& path) {
+    return InChild<LoadReport>([&] {
+        ClaudeConsole console;
+        console.SetOutputCallback([](const std::string&) {});
+        console.EnsureJavaScript();
+        LoadReport report;
+        report.micros = Seconds([&] { console.ExecuteFile(path); }) * 1e6;
+        report.stats = console.GetCodeCacheStats();
+        console.Shutdown();
+        return report;
+    });
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    size_t bytes = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 5 << 20;
+
+    // A private config directory, so the cache starts empty
+    fs::path home = fs::temp_directory_path() / std::format("cll_bench_code_cache_{}", getpid());
+    fs::create_directories(home);
+    setenv("HOME", home.c_str(), 1);
+    std::string path = (home / "bundle.js").string();
+    std::ofstream(path) << MakeBundle(bytes);
+
+    PrintHeader(std::format("ExecuteFile() of a {} byte bundle", fs::file_size(path)));
+    LoadReport cold = LoadInChild(path);
+    PrintRow("cold (compile, then write cache)", cold.micros, "us");
+    double stored = static_cast<double>(cold.stats.bytesWritten);
+    LoadReport warm = LoadInChild(path);
+    CodeCache::Stats stats = warm.stats;
+    PrintRow("warm (consume code cache)", warm.micros, "us");
+    if (stats.hits == 0) {
+        std::printf("  (no cache hit: %zu misses, %zu rejected%s)\n", stats.misses, stats.rejected,
+                    ClaudeConsole().EnsureJavaScript() ? "" : "; V8 not built");
+    } else {
+        PrintRow("cache size", stored / 1024, "KB");
+    }
+
+    fs::remove_all(home);
+    return 0;
+}
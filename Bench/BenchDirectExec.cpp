@@ -0,0 +1,35 @@
+// Simple commands exec'd directly versus through /bin/sh -c
+#include "BenchUtil.h"
+#include "ClaudeConsole.h"
+#include "ProcessExecutor.h"
+#include <cstdlib>
+#include <string>
+
+using namespace cll;
+using namespace cll::bench;
+
+int main(int argc, char* argv[]) {
+    int iterations = argc > 1 ? std::atoi(argv[1]) : 500;
+    ClaudeConsole console;
+    console.Initialize();
+    ProcessExecutor executor;
+    executor.StartServer();
+
+    for (const std::string command : {"uname -r", "cat /etc/hostname", "ls /", "ls /usr/bin/g*"}) {
+        std::vector<std::string> words;
+        if (!console.IsDirectCommand(command, words)) {
+            continue;
+        }
+        ProcessRequest direct;
+        direct.argv = words;
+
+        PrintHeader(std::to_string(iterations) + " x '" + command + "'");
+        PrintRow("sh -c via ProcessExecutor", MeanMicros(iterations, [&] { executor.ExecuteShell(command); }), "us/cmd");
+        PrintRow("direct exec via ProcessExecutor", MeanMicros(iterations, [&] { executor.Execute(direct); }), "us/cmd");
+        PrintRow("console (split, glob and exec)", MeanMicros(iterations, [&] { console.ExecuteShellCommand(command); }), "us/cmd");
+    }
+
+    executor.StopServer();
+    console.Shutdown();
+    return 0;
+}
@@ -0,0 +1,37 @@
+// Native pipelines versus handing the same line to /bin/sh
+#include "BenchUtil.h"
+#include "ProcessExecutor.h"
+#include <cstdlib>
+#include <string>
+
+using namespace cll;
+using namespace cll::bench;
+
+int main(int argc, char* argv[]) {
+    int iterations = argc > 1 ? std::atoi(argv[1]) : 200;
+    ProcessExecutor executor;
+    executor.StartServer();
+
+    struct Case {
+        std::string line;
+        std::vector<std::vector<std::string>> stages;
+    };
+    Case cases[] = {
+        {"seq 100 | wc -l", {{"seq", "100"}, {"wc", "-l"}}},
+        {"seq 1000 | grep 7 | sort -r | head -n 5", {{"seq", "1000"}, {"grep", "7"}, {"sort", "-r"}, {"head", "-n", "5"}}},
+    };
+    for (const auto& test : cases) {
+        PrintHeader(std::to_string(iterations) + " x '" + test.line + "'");
+        PrintRow("sh -c", MeanMicros(iterations, [&] { executor.ExecuteShell(test.line); }), "us/cmd");
+        PrintRow("native pipeline", MeanMicros(iterations, [&] { executor.ExecutePipeline(test.stages, {}); }), "us/cmd");
+    }
+
+    // Throughput across a boundary: 1 GB through cat
+    std::vector<std::vector<std::string>> bulk = {{"head", "-c", "1000000000", "/dev/zero"}, {"cat"}, {"wc", "-c"}};
+    PrintHeader("1 GB through 'head -c 1000000000 /dev/zero | cat | wc -c'");
+    PrintRow("sh -c", Seconds([&] { executor.ExecuteShell("head -c 1000000000 /dev/zero | cat | wc -c"); }), "s");
+    PrintRow("native pipeline", Seconds([&] { executor.ExecutePipeline(bulk, {}); }), "s");
+
+    executor.StopServer();
+    return 0;
+}
@@ -0,0 +1,49 @@
+// Compares the posix_spawn ProcessExecutor with the popen + fgets loop it replaced
+#include "BenchUtil.h"
+#include "ProcessExecutor.h"
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+
+using namespace cll;
+using namespace cll::bench;
+
+namespace {
+
+// The capture loop ExecuteShellCommand used before the executor existed
+std::string PopenCapture(const std::string& command) {
+    FILE* pipe = popen((command + " 2>&1").c_str(), "r");
+    if (!pipe) return "";
+    std::string output;
+    char buffer[256];
+    while (fgets(buffer, sizeof(buffer), pipe)) {
+        output += buffer;
+    }
+    pclose(pipe);
+    return output;
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    int iterations = argc > 1 ? std::atoi(argv[1]) : 500;
+    int megabytes = argc > 2 ? std::atoi(argv[2]) : 256;
+    ProcessExecutor executor;
+
+    PrintHeader("Spawn latency (" + std::to_string(iterations) + " x 'true')");
+    PrintRow("popen", MeanMicros(iterations, [] { PopenCapture("true"); }), "us/spawn");
+    PrintRow("ProcessExecutor (sh -c)", MeanMicros(iterations, [&] { executor.ExecuteShell("true"); }), "us/spawn");
+    ProcessRequest direct;
+    direct.argv = {"true"};
+    PrintRow("ProcessExecutor (direct argv)", MeanMicros(iterations, [&] { executor.Execute(direct); }), "us/spawn");
+
+    // Text output so fgets is not cut short by NUL bytes
+    std::string producer = "head -c " + std::to_string(megabytes) + "M /dev/zero | tr '\\0' 'x'";
+    PrintHeader("Read throughput (" + std::to_string(megabytes) + " MB)");
+    double popenSeconds = Seconds([&] { PopenCapture(producer); });
+    double executorSeconds = Seconds([&] { executor.ExecuteShell(producer); });
+    PrintRow("popen + fgets(256)", megabytes / popenSeconds, "MB/s");
+    PrintRow("ProcessExecutor read(64K)", megabytes / executorSeconds, "MB/s");
+
+    return 0;
+}
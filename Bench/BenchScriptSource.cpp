@@ -0,0 +1,108 @@
+// Reading a script for V8: istreambuf_iterator into a std::string that is
+// then copied into V8's heap, against ScriptSource's single exact-size
+// read handed over as an external string
+#include "BenchUtil.h"
+#include "ClaudeConsole.h"
+#include "ScriptSource.h"
+#include <cstdlib>
+#include <filesystem>
+#include <format>
+#include <fstream>
+#include <iterator>
+#include <sys/resource.h>
+#include <unistd.h>
+
+using namespace cll;
+using namespace cll::bench;
+namespace fs = std::filesystem;
+
+namespace {
+
+std::string MakeScript(size_t bytes, const char* comment) {
+    std::string source;
+    for (size_t i = 0; source.size() < bytes; ++i) {
+        source += std::format("function g{0}(x) {{ return x + {0}; }} // {1}\n", i, comment);
+    }
+    return source;
+}
+
+long PeakKilobytes() {
+    rusage usage{};
+    getrusage(RUSAGE_SELF, &usage);
+    return usage.ru_maxrss;
+}
+
+struct Cost {
+    double millis = -1;
+    double peakMegabytes = -1;
+};
+
+// Time and peak memory growth of one load, in a fresh process
+Cost Measure(const std::function<void()>& load) {
+    return InChild<Cost>([&] {
+        long before = PeakKilobytes();
+        Cost cost;
+        cost.millis = Seconds(load) * 1e3;
+        cost.peakMegabytes = (PeakKilobytes() - before) / 1024.0;
+        return cost;
+    });
+}
+
+void Report(const std::string& label, const Cost& cost) {
+    PrintRow(label + " time", cost.millis, "ms");
+    PrintRow(label + " peak growth", cost.peakMegabytes, "MB");
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    size_t bytes = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 50 << 20;
+    fs::path path = fs::temp_directory_path() / std::format("cll_bench_script_source_{}.js", getpid());
+
+    for (auto [name, comment] : {std::pair{"ASCII", "plain comment"},
+                                 std::pair{"UTF-8 (Latin-1)", "caf\xC3\xA9"},
+                                 std::pair{"UTF-8 (CJK)", "\xE6\xBC\xA2\xE5\xAD\x97"}}) {
+        std::ofstream(path, std::ios::binary | std::ios::trunc) << MakeScript(bytes, comment);
+        PrintHeader(std::format("{}, {} bytes", name, fs::file_size(path)));
+
+        // Before: what ExecuteFile did. The second copy stands in for the
+        // one NewFromUtf8 makes in V8's heap: the bytes for ASCII, decoded
+        // to one or two bytes per character otherwise.
+        Report("istreambuf + copy", Measure([&] {
+            std::ifstream file(path, std::ios::binary);
+            std::string source(std::istreambuf_iterator<char>(file), {});
+            std::string engineCopy;
+            std::u16string engineWide;
+            if (ScriptSource::IsAsciiText(source)) {
+                engineCopy = source;
+            } else {
+                ScriptSource::Decode(source, engineCopy, engineWide);
+            }
+            asm volatile("" : : "r"(engineCopy.data()), "r"(engineWide.data()) : "memory");
+        }));
+        Report("ScriptSource", Measure([&] {
+            std::string error;
+            auto source = ScriptSource::Open(path.string(), error);
+            asm volatile("" : : "r"(source.get()) : "memory");
+        }));
+
+        // The whole load, compile and run included, when V8 is there
+        Cost execute = Measure([&] {
+            ClaudeConsole console;
+            console.SetOutputCallback([](const std::string&) {});
+            console.SetCodeCache(false);
+            console.SetStreamingThreshold(0);
+            if (console.EnsureJavaScript()) {
+                console.ExecuteFile(path.string());
+            }
+            console.Shutdown();
+        });
+        Report("ExecuteFile", execute);
+    }
+    if (!ClaudeConsole().EnsureJavaScript()) {
+        std::printf("\n  (V8 not built: ExecuteFile rows are console setup only)\n");
+    }
+
+    fs::remove(path);
+    return 0;
+}
@@ -0,0 +1,26 @@
+// Per-command cost of a fresh /bin/sh versus the persistent shell session
+#include "BenchUtil.h"
+#include "ProcessExecutor.h"
+#include "ShellSession.h"
+#include <cstdlib>
+#include <string>
+
+using namespace cll;
+using namespace cll::bench;
+
+int main(int argc, char* argv[]) {
+    int iterations = argc > 1 ? std::atoi(argv[1]) : 2000;
+    ProcessExecutor executor;
+    ShellSession session(executor);
+
+    // Start the session outside the timed region
+    session.Execute(":");
+
+    for (const std::string command : {":", "echo hello", "test -d /tmp && echo yes"}) {
+        PrintHeader(std::to_string(iterations) + " x '" + command + "'");
+        PrintRow("fresh sh -c per command", MeanMicros(iterations, [&] { executor.ExecuteShell(command); }), "us/cmd");
+        PrintRow("persistent session", MeanMicros(iterations, [&] { session.Execute(command); }), "us/cmd");
+    }
+
+    return 0;
+}
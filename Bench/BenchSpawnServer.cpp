@@ -0,0 +1,70 @@
+// Spawn latency as the console's heap grows: popen, fork+exec and local
+// posix_spawn all start from this process, the spawn server does not
+#include "BenchUtil.h"
+#include "ProcessExecutor.h"
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <vector>
+#include <sys/wait.h>
+#include <unistd.h>
+
+using namespace cll;
+using namespace cll::bench;
+
+namespace {
+
+void RunPopen() {
+    FILE* pipe = popen("true", "r");
+    char buffer[128];
+    while (fgets(buffer, sizeof(buffer), pipe)) {
+    }
+    pclose(pipe);
+}
+
+void RunForkExec() {
+    pid_t pid = fork();
+    if (pid == 0) {
+        execl("/bin/true", "true", static_cast<char*>(nullptr));
+        _exit(127);
+    }
+    int status;
+    waitpid(pid, &status, 0);
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    size_t maxMegabytes = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 2000;
+    int iterations = argc > 2 ? std::atoi(argv[2]) : 200;
+
+    // Fork the server first, the way ClaudeConsole::Initialize does
+    ProcessExecutor server;
+    server.StartServer();
+    ProcessExecutor local;
+
+    ProcessRequest request;
+    request.argv = {"/bin/true"};
+
+    // Touched pages stand in for a populated V8 heap
+    std::vector<std::unique_ptr<char[]>> heap;
+    size_t heapMegabytes = 0;
+    for (size_t target : {10, 100, 500, 1000, 2000}) {
+        if (target > maxMegabytes) break;
+        while (heapMegabytes < target) {
+            heap.emplace_back(new char[1024 * 1024]);
+            std::memset(heap.back().get(), 1, 1024 * 1024);
+            ++heapMegabytes;
+        }
+
+        PrintHeader(std::to_string(heapMegabytes) + " MB heap, " + std::to_string(iterations) + " x /bin/true");
+        PrintRow("popen", MeanMicros(iterations, RunPopen), "us/spawn");
+        PrintRow("fork + exec", MeanMicros(iterations, RunForkExec), "us/spawn");
+        PrintRow("posix_spawn from this process", MeanMicros(iterations, [&] { local.Execute(request); }), "us/spawn");
+        PrintRow("spawn server", MeanMicros(iterations, [&] { server.Execute(request); }), "us/spawn");
+    }
+
+    return 0;
+}
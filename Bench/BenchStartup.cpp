@@ -0,0 +1,39 @@
+// Console startup with V8 set up lazily, against setting it up eagerly
+#include "BenchUtil.h"
+#include "ClaudeConsole.h"
+#include <cstdlib>
+
+using namespace cll;
+using namespace cll::bench;
+
+int main(int argc, char* argv[]) {
+    int iterations = argc > 1 ? std::atoi(argv[1]) : 20;
+
+    // What a Shell-only session pays before its first prompt
+    PrintHeader(std::to_string(iterations) + " x construct + Initialize()");
+    PrintRow("lazy (V8 on first use)", MeanMicros(iterations, [] {
+        ClaudeConsole console;
+        console.Initialize();
+        console.Shutdown();
+    }), "us");
+
+    // V8 can only be initialized once per process, so the JavaScript side
+    // is timed once. Eager startup paid this before the first prompt.
+    ClaudeConsole console;
+    console.SetOutputCallback([](const std::string&) {});
+    console.Initialize();
+    // Run with CLL_STARTUP_SNAPSHOT set to a cll_snapshot output, and
+    // without, to compare deserializing against building the context
+    PrintHeader("V8 setup (once)");
+    bool ready = false;
+    PrintRow("EnsureJavaScript()", Seconds([&] { ready = console.EnsureJavaScript(); }) * 1e6, "us");
+    if (!ready) {
+        std::printf("  (V8 not built: JavaScript lines are simulated)\n");
+    } else {
+        std::printf("  (context %s)\n", console.UsesStartupSnapshot() ? "from the startup snapshot" : "built from scratch");
+    }
+    PrintRow("first JavaScript line", Seconds([&] { console.ExecuteJavaScript("1 + 1"); }) * 1e6, "us");
+    PrintRow("second JavaScript line", Seconds([&] { console.ExecuteJavaScript("1 + 1"); }) * 1e6, "us");
+    console.Shutdown();
+    return 0;
+}
@@ -0,0 +1,76 @@
+// Loading a large generated script: compiled on the REPL thread, streamed
+// from a worker thread, and streamed in the background behind the prompt
+#include "BenchUtil.h"
+#include "ClaudeConsole.h"
+#include <cstdlib>
+#include <filesystem>
+#include <format>
+#include <fstream>
+#include <unistd.h>
+
+using namespace cll;
+using namespace cll::bench;
+namespace fs = std::filesystem;
+
+namespace {
+
+std::string MakeScript(size_t bytes) {
+    std::string source;
+    for (size_t i = 0; source.size() < bytes; ++i) {
+        source += std::format("function f{0}(a) {{ let s = 0; for (let i = 0; i < a; i++) s += i * {0}; "
+                              "return [s, 'item {0}', {{ n: {0} }}]; }}\n", i);
+    }
+    source += "var loaded = true;\n";
+    return source;
+}
+
+struct LoadTimes {
+    double untilReturn = -1;
+    double untilRun = -1;
+};
+
+// A fresh process per load, with the code and script caches off so every
+// run parses the whole file
+LoadTimes Load(const std::string& path, size_t streamingThreshold, bool background) {
+    return InChild<LoadTimes>([&] {
+        ClaudeConsole console;
+        console.SetOutputCallback([](const std::string&) {});
+        console.SetCodeCache(false);
+        console.SetScriptCacheCapacity(0);
+        console.SetStreamingThreshold(streamingThreshold);
+        console.EnsureJavaScript();
+        LoadTimes times;
+        auto start = Clock::now();
+        if (background) {
+            console.LoadFileInBackground(path);
+        } else {
+            console.ExecuteFile(path);
+        }
+        times.untilReturn = std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+        console.RunFinishedLoads(true);
+        times.untilRun = std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+        console.Shutdown();
+        return times;
+    });
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    size_t bytes = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 50 << 20;
+    fs::path path = fs::temp_directory_path() / std::format("cll_bench_streaming_{}.js", getpid());
+    std::ofstream(path) << MakeScript(bytes);
+
+    PrintHeader(std::format("{} byte script", fs::file_size(path)));
+    PrintRow("ExecuteFile, compiled in place", Load(path, 0, false).untilRun, "ms");
+    PrintRow("ExecuteFile, streamed", Load(path, 1, false).untilRun, "ms");
+    LoadTimes background = Load(path, 0, true);
+    PrintRow("background load, until prompt", background.untilReturn, "ms");
+    PrintRow("background load, until run", background.untilRun, "ms");
+    if (!ClaudeConsole().EnsureJavaScript()) {
+        std::printf("  (V8 not built: nothing is compiled)\n");
+    }
+
+    fs::remove(path);
+    return 0;
+}
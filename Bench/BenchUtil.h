@@ -0,0 +1,66 @@
+#pragma once
+
+#include <chrono>
+#include <cstdio>
+#include <string>
+#include <functional>
+#include <type_traits>
+#include <sys/wait.h>
+#include <unistd.h>
+
+namespace cll::bench {
+
+using Clock = std::chrono::steady_clock;
+
+// Run a body repeatedly and return the mean wall time per iteration in microseconds
+inline double MeanMicros(int iterations, const std::function<void()>& body) {
+    auto start = Clock::now();
+    for (int i = 0; i < iterations; ++i) {
+        body();
+    }
+    auto elapsed = std::chrono::duration<double, std::micro>(Clock::now() - start);
+    return elapsed.count() / iterations;
+}
+
+// Time a single run of a body in seconds
+inline double Seconds(const std::function<void()>& body) {
+    auto start = Clock::now();
+    body();
+    return std::chrono::duration<double>(Clock::now() - start).count();
+}
+
+// Run a body in a forked child and return what it measured, for work that
+// must start from a fresh process each time (V8 keeps per-process state)
+template <typename Report>
+Report InChild(const std::function<Report()>& body) {
+    static_assert(std::is_trivially_copyable_v<Report>);
+    Report report{};
+    int fds[2];
+    if (pipe(fds) != 0) return report;
+    pid_t pid = fork();
+    if (pid == 0) {
+        close(fds[0]);
+        Report measured = body();
+        ssize_t ignored = write(fds[1], &measured, sizeof(measured));
+        (void)ignored;
+        _exit(0);
+    }
+    close(fds[1]);
+    if (pid > 0) {
+        ssize_t got = read(fds[0], &report, sizeof(report));
+        if (got != static_cast<ssize_t>(sizeof(report))) report = Report{};
+        waitpid(pid, nullptr, 0);
+    }
+    close(fds[0]);
+    return report;
+}
+
+inline void PrintHeader(const std::string& title) {
+    std::printf("\n== %s ==\n", title.c_str());
+}
+
+inline void PrintRow(const std::string& label, double value, const char* unit) {
+    std::printf("  %-36s %12.1f %s\n", label.c_str(), value, unit);
+}
+
+} // namespace cll::bench
@@ -0,0 +1,32 @@
+#pragma once
+
+#include <atomic>
+
+namespace cll {
+
+// A cancel request that can be raised from a signal handler or another
+// thread. Waiters poll Fd(), which becomes readable once Cancel() is called.
+class CancelToken {
+public:
+    CancelToken();
+    ~CancelToken();
+
+    CancelToken(const CancelToken&) = delete;
+    CancelToken& operator=(const CancelToken&) = delete;
+
+    // Async-signal-safe
+    void Cancel();
+
+    // Clear the request before starting the next command
+    void Reset();
+
+    bool IsCancelled() const { return cancelled_.load(); }
+    int Fd() const { return readFd_; }
+
+private:
+    std::atomic<bool> cancelled_{false};
+    int readFd_ = -1;
+    int writeFd_ = -1;
+};
+
+} // namespace cll
@@ -1,11 +1,27 @@
 #pragma once
 
 #include <string>
+#include <string_view>
 #include <vector>
+#include <deque>
 #include <map>
 #include <chrono>
 #include <memory>
 #include <functional>
+#include <optional>
+#include <mutex>
+#include <thread>
+#include "CommandResult.h"
+#include "OutputStore.h"
+#include "ProcessExecutor.h"
+#include "ShellSession.h"
+#include "JobTable.h"
+#include "CancelToken.h"
+#include "CodeCache.h"
+#include "LruCache.h"
+#include "PathCache.h"
+#include "ScriptSource.h"
+#include "SourceManifest.h"
 
 // V8 integration (conditional)
 #ifdef HAS_V8
@@ -17,17 +33,9 @@ namespace cll {
 #ifdef HAS_V8
 // Forward declaration for DLL loader
 class DllLoader;
+class StreamedScript;
 #endif
 
-// Command result structure
-struct CommandResult {
-    bool success;
-    std::string output;
-    std::string error;
-    std::chrono::microseconds executionTime;
-    int exitCode;
-};
-
 // Console mode
 enum class ConsoleMode {
     Shell,
@@ -51,6 +59,28 @@ public:
     // Initialize console
     bool Initialize();
     void Shutdown();
+    
+    // Lazy JavaScript startup, with optional background warm-up
+    bool EnsureJavaScript();
+    void WarmUpJavaScript();
+    bool IsJavaScriptReady() const;
+    void SetJavaScriptWarmUp(bool enabled) { warmUpJavaScript_ = enabled; }
+    bool GetJavaScriptWarmUp() const { return warmUpJavaScript_; }
+    
+    // Startup snapshot (CLL_STARTUP_SNAPSHOT overrides the path)
+    static constexpr const char* StartupSnapshotName = "cll_snapshot.bin";
+    static std::string StartupSnapshotPath();
+    // Starts and disposes of V8 itself, so only for a process without it
+    static bool WriteStartupSnapshot(const std::string& path, std::string& error);
+    bool UsesStartupSnapshot() const { return usesStartupSnapshot_; }
+    
+    // Per-user snapshot of init.js, rebuilt when its sources change
+    std::string InitScriptPath() const;
+    std::string InitSnapshotPath() const;
+    bool WriteInitSnapshot(const std::string& path, std::string& error);
+    bool UsesInitSnapshot() const { return usesInitSnapshot_; }
+    void SetInitSnapshot(bool enabled) { initSnapshot_ = enabled; }
+    bool GetInitSnapshot() const { return initSnapshot_; }
 
     // Execute commands
     CommandResult ExecuteCommand(const std::string& command);
@@ -63,6 +93,34 @@ public:
     bool ExecuteFile(const std::string& path);
     bool ExecuteString(const std::string& source, const std::string& name = "<eval>");
     
+    // Code cache for ExecuteFile and load()
+    void SetCodeCache(bool enabled) { codeCacheEnabled_ = enabled; }
+    bool GetCodeCache() const { return codeCacheEnabled_; }
+    std::string CodeCachePath() const;
+    CodeCache::Stats GetCodeCacheStats() const { return codeCache_ ? codeCache_->GetStats() : CodeCache::Stats{}; }
+    
+    // In-memory cache of compiled scripts (zero capacity turns it off)
+    static constexpr size_t DefaultScriptCacheCapacity = 256;
+    static constexpr size_t ScriptCacheInlineKeyBytes = 4096;
+    void SetScriptCacheCapacity(size_t capacity);
+    size_t GetScriptCacheCapacity() const { return scriptCacheCapacity_; }
+    LruStats GetScriptCacheStats() const;
+    
+    // Streaming compilation of large and background loads
+    static constexpr size_t DefaultStreamingThreshold = 16 << 20;
+    void SetStreamingThreshold(size_t bytes) { streamingThreshold_ = bytes; }
+    size_t GetStreamingThreshold() const { return streamingThreshold_; }
+    bool LoadFileInBackground(const std::string& path);
+    size_t RunFinishedLoads(bool wait = false);
+    size_t PendingLoads() const;
+    
+    // V8 message loop and idle tasks (zero budget turns idle tasks off)
+    static constexpr std::chrono::milliseconds DefaultIdleTaskBudget{20};
+    void SetIdleTaskBudget(std::chrono::milliseconds budget) { idleTaskBudget_ = budget; }
+    std::chrono::milliseconds GetIdleTaskBudget() const { return idleTaskBudget_; }
+    size_t PumpMessageLoop();
+    void RunIdleTasks();
+    
     // DLL loading
     bool LoadDll(const std::string& path);
     bool UnloadDll(const std::string& path);
@@ -87,14 +145,104 @@ public:
     bool IsBuiltinCommand(const std::string& command) const;
     CommandResult ExecuteBuiltinCommand(const std::string& command);
     
+    // Native shell builtins (cd, pwd, export, echo, env, which)
+    bool IsNativeBuiltin(const std::string& command) const;
+    // Split a line with no shell syntax into words
+    static bool SplitSimpleCommand(const std::string& command, std::vector<std::string>& words,
+                                   bool expandGlobs = false);
+    
+    // PATH index
+    PathCache& GetPathCache() { return pathCache_; }
+    bool IsUnknownCommand(const std::string& command);
+    
+    // Native pipelines of programs on PATH
+    static bool SplitPipeline(const std::string& command, std::vector<std::vector<std::string>>& stages);
+    bool IsNativePipeline(const std::string& command, std::vector<std::vector<std::string>>& stages);
+    
+    // Direct exec of simple lines without /bin/sh
+    bool IsDirectCommand(const std::string& command, std::vector<std::string>& argv);
+    
+    // Command substitution in Shell lines
+    struct SubstitutionPart {
+        std::string text;
+        bool isCommand = false;
+    };
+    static constexpr size_t MaxSubstitutionWorkers = 8;
+    static bool ParseSubstitutions(const std::string& line, std::vector<SubstitutionPart>& parts);
+    // Outputs come back as variables, referenced from the line as ${name}
+    using SubstitutionVariables = std::vector<std::pair<std::string, std::string>>;
+    bool ExpandSubstitutions(const std::string& line, std::string& expanded, SubstitutionVariables& variables);
+    
     // Utilities
     static std::string FormatExecutionTime(const std::chrono::microseconds& us);
+    static std::string FormatExecutionTime(const CommandResult& result);
+    static std::string FormatResourceUsage(const ResourceUsage& usage);
     static std::vector<std::string> SplitCommand(const std::string& command);
     
     // Output callbacks
     using OutputCallback = std::function<void(const std::string&)>;
     void SetOutputCallback(OutputCallback callback) { outputCallback_ = callback; }
     void SetErrorCallback(OutputCallback callback) { errorCallback_ = callback; }
+    
+    // Streaming shell output
+    using ChunkCallback = std::function<void(std::string_view)>;
+    static constexpr size_t StreamChunkSize = ProcessExecutor::ReadChunkSize;
+    CommandResult ExecuteShellCommand(const std::string& command, const ChunkCallback& onChunk,
+                                      const ChunkCallback& onErrorChunk = nullptr,
+                                      std::optional<std::string_view> input = std::nullopt,
+                                      const ProcessLimits* limits = nullptr);
+    void SetStreamingOutput(bool enabled) { streamingOutput_ = enabled; }
+    bool IsStreamingOutput() const { return streamingOutput_; }
+    
+    // Captured shell output, spilled to a temp file past the threshold
+    static constexpr size_t DefaultOutputSpillThreshold = 64 << 20;
+    CommandResult CaptureShellCommand(const std::string& command,
+                                      std::optional<std::string_view> input = std::nullopt,
+                                      const ProcessLimits* limits = nullptr);
+    void SetOutputSpillThreshold(size_t bytes) { outputSpillThreshold_ = bytes; }
+    size_t GetOutputSpillThreshold() const { return outputSpillThreshold_; }
+    
+    // Output retention
+    void SetOutputRetention(OutputRetention retention, size_t bytes = DefaultOutputRetainBytes);
+    OutputRetention GetOutputRetention() const { return outputRetention_; }
+    size_t GetOutputRetainBytes() const { return outputRetainBytes_; }
+    static constexpr size_t DefaultOutputRetainBytes = 64 << 10;
+    
+    // Stdin feeds ("cmd <<< $_")
+    static bool SplitStdinFeed(const std::string& command, std::string& rest);
+    const CommandResult& GetLastResult() const { return lastResult_; }
+    
+    // Resource usage of the most recent shell command
+    const ResourceUsage& GetLastUsage() const { return lastResult_.usage; }
+    
+    // Resource limits and scheduling
+    void SetCommandLimits(const ProcessLimits& limits);
+    const ProcessLimits& GetCommandLimits() const { return commandLimits_; }
+    static bool SplitLimitPrefix(const std::string& command, ProcessLimits& limits, std::string& rest,
+                                 std::string& error);
+    
+    // CPU affinity for the REPL and V8 worker threads
+    bool SetReplCpus(const cpu_set_t& cpus);
+    void SetJavaScriptWorkerCpus(const cpu_set_t& cpus) { javaScriptWorkerCpus_ = cpus; }
+    
+    // Persistent shell session
+    void SetPersistentShell(bool enabled);
+    bool IsPersistentShell() const { return persistentShell_; }
+    
+    // Background jobs
+    CommandResult StartBackgroundJob(const std::string& command);
+    std::vector<JobReport> TakeFinishedJobs() { return jobs_.TakeFinished(); }
+    static std::string FormatJobReport(const JobReport& report);
+    static bool IsBackgroundCommand(const std::string& command);
+    
+    // Cancellation and timeouts (zero means no limit)
+    void RequestCancel() { cancel_.Cancel(); }
+    void SetShellTimeout(std::chrono::milliseconds timeout);
+    void SetJavaScriptTimeout(std::chrono::milliseconds timeout) { javaScriptTimeout_ = timeout; }
+    void SetAskTimeout(std::chrono::milliseconds timeout) { askTimeout_ = timeout; }
+    std::chrono::milliseconds GetShellTimeout() const { return shellTimeout_; }
+    std::chrono::milliseconds GetJavaScriptTimeout() const { return javaScriptTimeout_; }
+    std::chrono::milliseconds GetAskTimeout() const { return askTimeout_; }
 
 protected:
     // Output handling
@@ -105,31 +253,99 @@ private:
     ConsoleMode mode_;
     MultiLineMode multiLineMode_;
     std::string multiLineBuffer_;
+    bool streamingOutput_;
+    bool persistentShell_;
     std::map<std::string, std::string> builtinCommands_;
+    std::map<std::string, std::string> jobCommands_;
     std::map<std::string, std::string> aliases_;
     
     // Configuration
     std::string promptFormat_;
     std::string claudePrompt_;
     std::string claudePromptColor_;
+    std::chrono::milliseconds shellTimeout_;
+    std::chrono::milliseconds javaScriptTimeout_;
+    std::chrono::milliseconds askTimeout_;
+    size_t outputSpillThreshold_;
+    OutputRetention outputRetention_;
+    size_t outputRetainBytes_;
+    CommandResult lastResult_;
+    bool warmUpJavaScript_ = false;
+    bool usesStartupSnapshot_ = false;
+    bool initSnapshot_ = true;
+    bool usesInitSnapshot_ = false;
+    bool codeCacheEnabled_ = true;
+    std::unique_ptr<CodeCache> codeCache_;
+    size_t scriptCacheCapacity_ = DefaultScriptCacheCapacity;
+    size_t streamingThreshold_ = DefaultStreamingThreshold;
+    std::chrono::milliseconds idleTaskBudget_ = DefaultIdleTaskBudget;
+    ProcessLimits commandLimits_;
+    std::optional<cpu_set_t> replCpus_;
+    std::optional<cpu_set_t> javaScriptWorkerCpus_;
+    cpu_set_t processCpus_;
+    
+    // The configured limits, plus extra ones for a single command
+    ProcessLimits EffectiveLimits(const ProcessLimits* extra = nullptr) const;
     
     OutputCallback outputCallback_;
     OutputCallback errorCallback_;
     
+    // Child process spawning for shell commands and subprocesses
+    PathCache pathCache_;
+    ProcessExecutor executor_;
+    std::unique_ptr<ShellSession> shellSession_;
+    JobTable jobs_;
+    CancelToken cancel_;
+    
+    CommandResult ExecuteJobCommand(const std::vector<std::string>& words);
+    
+    // Native builtins return false to hand the line to the shell instead
+    using NativeBuiltin = bool (ClaudeConsole::*)(const std::vector<std::string>& args, CommandResult& result);
+    std::map<std::string, NativeBuiltin> nativeBuiltins_;
+    bool TryNativeBuiltin(const std::string& command, CommandResult& result);
+    bool BuiltinCd(const std::vector<std::string>& args, CommandResult& result);
+    bool BuiltinPwd(const std::vector<std::string>& args, CommandResult& result);
+    bool BuiltinExport(const std::vector<std::string>& args, CommandResult& result);
+    bool BuiltinEcho(const std::vector<std::string>& args, CommandResult& result);
+    bool BuiltinEnv(const std::vector<std::string>& args, CommandResult& result);
+    bool BuiltinWhich(const std::vector<std::string>& args, CommandResult& result);
+    bool BuiltinHash(const std::vector<std::string>& args, CommandResult& result);
+    
 #ifdef HAS_V8
     // V8 JavaScript engine
     std::unique_ptr<v8::Platform> platform_;
     v8::Isolate* isolate_;
     v8::Persistent<v8::Context> context_;
+    std::thread warmUpThread_;
+    std::mutex javaScriptMutex_;
+    // Whether a watchdog already covers the JavaScript running now
+    bool scriptWatched_ = false;
+    static std::unique_ptr<v8::Platform> StartV8Platform();
+    LruCache<v8::Global<v8::UnboundScript>> scriptCache_{DefaultScriptCacheCapacity};
+    std::deque<std::unique_ptr<StreamedScript>> backgroundLoads_;
+    bool RunStreamed(StreamedScript& streamed);
     
     // DLL loader for hot-loading native libraries
     std::unique_ptr<DllLoader> dllLoader_;
     
     // V8 helper methods
-    bool CompileAndRun(const std::string& source, const std::string& name);
-    std::string ReadFile(const std::string& path);
+    bool CompileAndRun(std::string_view source, const std::string& name, bool useCodeCache = false,
+                       const std::shared_ptr<const ScriptSource>& file = nullptr);
+    bool RunScript(v8::Local<v8::Script> script, const std::string& name, v8::TryCatch& tryCatch);
     void ReportException(v8::TryCatch* tryCatch);
-    void RegisterBuiltins(v8::Local<v8::Context> context);
+    static void RegisterBuiltins(v8::Isolate* isolate, v8::Local<v8::Context> context);
+    static const intptr_t* ExternalReferences();
+    
+    // The snapshot in use, kept for as long as the isolate made from it
+    std::string snapshotData_;
+    v8::StartupData snapshotBlob_{};
+    bool LoadStartupSnapshot();
+    bool LoadInitSnapshot();
+    bool ReadSnapshot(const std::string& path, const std::string& key);
+    
+    // State while an init snapshot is built
+    SourceManifest* snapshotSources_ = nullptr;
+    bool snapshotUnsupported_ = false;
     void PrintResult(v8::Local<v8::Value> value);
     
     // V8 built-in functions
@@ -139,6 +355,8 @@ private:
     static void UnloadDllFunc(const v8::FunctionCallbackInfo<v8::Value>& args);
     static void ReloadDllFunc(const v8::FunctionCallbackInfo<v8::Value>& args);
     static void ListDllsFunc(const v8::FunctionCallbackInfo<v8::Value>& args);
+    static void ShFunc(const v8::FunctionCallbackInfo<v8::Value>& args);
+    static void LastUsageFunc(const v8::FunctionCallbackInfo<v8::Value>& args);
     static void QuitFunc(const v8::FunctionCallbackInfo<v8::Value>& args);
     static void HelpFunc(const v8::FunctionCallbackInfo<v8::Value>& args);
     
@@ -150,7 +368,8 @@ public:
     // Claude integration helpers
     bool CheckClaudeAvailability();
     std::string FindPyClaudeCliPath();
-    CommandResult ExecuteSubprocess(const std::string& command);
+    CommandResult ExecuteSubprocess(const std::string& command,
+                                    std::chrono::milliseconds timeout = std::chrono::milliseconds(0));
     
     // Configuration management
     void CreateConfigDirectory();
@@ -0,0 +1,52 @@
+#pragma once
+
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <string_view>
+
+namespace cll {
+
+// On-disk store for V8 code cache data (ScriptCompiler::CreateCodeCache),
+// one file per script named by a hash of its source. Each file records
+// the engine version and source length it was made for, so a different
+// V8, or a colliding script, reads as a miss rather than feeding V8 data
+// it would reject.
+class CodeCache {
+public:
+    struct Stats {
+        size_t hits = 0;       // cache given to V8 and accepted
+        size_t misses = 0;     // no usable file
+        size_t rejected = 0;   // V8 refused the data and compiled afresh
+        size_t stored = 0;
+        uint64_t bytesRead = 0;
+        uint64_t bytesWritten = 0;
+    };
+
+    CodeCache(std::string directory, std::string engineVersion);
+
+    // The cached data for a script's source, if any
+    std::optional<std::string> Find(std::string_view source);
+
+    // Save data made for source, replacing any earlier file
+    bool Store(std::string_view source, std::string_view data);
+
+    // Count data that Find returned and V8 rejected, and delete its file
+    void Reject(std::string_view source);
+
+    // Count a Find result that V8 accepted
+    void Accept() { ++stats_.hits; }
+
+    const Stats& GetStats() const { return stats_; }
+    const std::string& Directory() const { return directory_; }
+    std::string PathFor(std::string_view source) const;
+
+private:
+    std::string Header(std::string_view source) const;
+
+    std::string directory_;
+    std::string engineVersion_;
+    Stats stats_;
+};
+
+} // namespace cll
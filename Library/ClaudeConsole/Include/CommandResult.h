@@ -0,0 +1,78 @@
+#pragma once
+
+#include <algorithm>
+#include <string>
+#include <string_view>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <vector>
+#include "SpilledOutput.h"
+
+namespace cll {
+
+// What a finished child used, as reported by wait4()
+struct ResourceUsage {
+    bool measured = false;                      // false where no child could be waited for
+    std::chrono::microseconds userTime{0};
+    std::chrono::microseconds systemTime{0};
+    long maxRssKb = 0;
+    long voluntarySwitches = 0;                 // mostly waiting for I/O
+    long involuntarySwitches = 0;               // preempted
+    uint64_t bytesRead = 0;                     // storage I/O: block counts x 512
+    uint64_t bytesWritten = 0;
+
+    // Combine with another process's usage, e.g. a later pipeline stage
+    void Add(const ResourceUsage& other) {
+        measured = measured || other.measured;
+        userTime += other.userTime;
+        systemTime += other.systemTime;
+        maxRssKb = std::max(maxRssKb, other.maxRssKb);
+        voluntarySwitches += other.voluntarySwitches;
+        involuntarySwitches += other.involuntarySwitches;
+        bytesRead += other.bytesRead;
+        bytesWritten += other.bytesWritten;
+    }
+};
+
+// Timing and traffic for one stage of a native pipeline
+struct StageStats {
+    std::string command;
+    std::chrono::microseconds wallTime{0};    // from spawn until its output closed
+    std::chrono::microseconds cpuTime{0};     // user plus system
+    uint64_t bytesOut = 0;                    // bytes written to the next stage (or to us)
+    int exitCode = 0;
+};
+
+// Command result structure
+struct CommandResult {
+    bool success;
+    std::string output;
+    std::string error;
+    std::chrono::microseconds executionTime;
+    int exitCode;
+    
+    // Stopped by its deadline or by a cancel request (e.g. Ctrl-C)
+    bool timedOut = false;
+    bool cancelled = false;
+    
+    // Output too large to keep in memory lives here instead of in output
+    std::shared_ptr<const SpilledOutput> spilledOutput = nullptr;
+    
+    // Output bytes left out under a head/tail retention policy
+    uint64_t droppedBytes = 0;
+    
+    // CPU, memory, context switches and I/O of the child (all stages of a
+    // native pipeline together)
+    ResourceUsage usage = {};
+    
+    // Per-stage figures when the command ran as a native pipeline
+    std::vector<StageStats> stages = {};
+    
+    // The output wherever it is kept
+    std::string_view OutputView() const {
+        return spilledOutput ? spilledOutput->View() : std::string_view(output);
+    }
+};
+
+} // namespace cll
@@ -0,0 +1,94 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <condition_variable>
+#include <sys/types.h>
+#include "CommandResult.h"
+#include "ProcessExecutor.h"
+#include "CancelToken.h"
+
+namespace cll {
+
+// A background job as shown by "jobs"
+struct JobInfo {
+    int id = 0;
+    pid_t pid = -1;
+    std::string command;
+    bool done = false;
+};
+
+// A finished background job; the result holds the tail of its output
+struct JobReport {
+    int id = 0;
+    std::string command;
+    CommandResult result;
+};
+
+// Background jobs started with a trailing '&'. Each job runs through
+// /bin/sh -c in a process group of its own with stdin at EOF; a waiter
+// thread keeps the tail of its output and reaps it. Finished jobs stay in
+// the table until they are waited for or taken for reporting.
+class JobTable {
+public:
+    static constexpr size_t OutputTailSize = 4096;
+    // How often a wait checks for a cancel request, which is signal-driven
+    static constexpr std::chrono::milliseconds CancelPollInterval{50};
+
+    explicit JobTable(ProcessExecutor& executor);
+    ~JobTable();
+
+    JobTable(const JobTable&) = delete;
+    JobTable& operator=(const JobTable&) = delete;
+
+    // Start a command line in the background, under limits, and describe the new job
+    bool Start(const std::string& command, JobInfo& job, std::string& error,
+               const ProcessLimits& limits = {});
+
+    // Block until a job finishes and remove it; false if there is no such job.
+    // A cancel request stops the wait, leaving the job running, and the
+    // report's result marked cancelled.
+    bool Wait(int id, JobReport& report, const CancelToken* cancel = nullptr);
+
+    // Continue a job in the foreground: it gets the terminal, if we have
+    // one, and a cancel request is passed on to it as SIGINT (then SIGKILL),
+    // as Ctrl-C would be; otherwise like Wait
+    bool Foreground(int id, JobReport& report, const CancelToken* cancel = nullptr);
+
+    // Send SIGCONT to a job's process group
+    bool Continue(int id);
+
+    // Remove and return the jobs that have finished since the last call
+    std::vector<JobReport> TakeFinished();
+
+    std::vector<JobInfo> List() const;
+
+    // The most recently started job, or 0 when there are none
+    int Current() const;
+
+    // Hang up every running job and wait for the waiters to finish
+    void TerminateAll();
+
+private:
+    struct Job {
+        JobInfo info;
+        CommandResult result;
+        std::thread waiter;
+    };
+
+    void Run(Job* job, ProcessRequest request, ChildProcess child,
+             std::chrono::high_resolution_clock::time_point startTime);
+    JobReport Remove(std::map<int, std::unique_ptr<Job>>::iterator it);
+    bool WaitFor(int id, JobReport& report, const CancelToken* cancel, bool foreground);
+
+    ProcessExecutor& executor_;
+    mutable std::mutex mutex_;
+    std::condition_variable changed_;
+    std::map<int, std::unique_ptr<Job>> jobs_;
+};
+
+} // namespace cll
@@ -0,0 +1,111 @@
+#pragma once
+
+#include <cstddef>
+#include <list>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+
+namespace cll {
+
+struct LruStats {
+    size_t hits = 0;
+    size_t misses = 0;
+    size_t evictions = 0;
+    size_t entries = 0;
+    size_t capacity = 0;
+    size_t keyBytes = 0;
+
+    double HitRate() const {
+        size_t lookups = hits + misses;
+        return lookups ? static_cast<double>(hits) / lookups : 0.0;
+    }
+};
+
+// Bounded map from string keys to move-only values, dropping the least
+// recently used entry when full. Keys are stored once, in the recency
+// list; the index refers to them. A capacity of zero caches nothing.
+template <typename Value>
+class LruCache {
+public:
+    using Stats = LruStats;
+
+    explicit LruCache(size_t capacity) : capacity_(capacity) {}
+
+    LruCache(const LruCache&) = delete;
+    LruCache& operator=(const LruCache&) = delete;
+
+    // The value for key, now the most recently used, or nullptr
+    Value* Find(std::string_view key) {
+        auto found = index_.find(key);
+        if (found == index_.end()) {
+            ++stats_.misses;
+            return nullptr;
+        }
+        ++stats_.hits;
+        entries_.splice(entries_.begin(), entries_, found->second);
+        return &found->second->second;
+    }
+
+    // Add or replace key's value, evicting as needed
+    void Insert(std::string key, Value value) {
+        if (capacity_ == 0) return;
+        auto found = index_.find(key);
+        if (found != index_.end()) {
+            found->second->second = std::move(value);
+            entries_.splice(entries_.begin(), entries_, found->second);
+            return;
+        }
+        while (entries_.size() >= capacity_) {
+            EvictOldest();
+        }
+        keyBytes_ += key.size();
+        entries_.emplace_front(std::move(key), std::move(value));
+        index_.emplace(entries_.front().first, entries_.begin());
+    }
+
+    // Change the capacity, evicting the oldest entries past it
+    void SetCapacity(size_t capacity) {
+        capacity_ = capacity;
+        while (entries_.size() > capacity_) {
+            EvictOldest();
+        }
+    }
+
+    void Clear() {
+        index_.clear();
+        entries_.clear();
+        keyBytes_ = 0;
+    }
+
+    size_t Size() const { return entries_.size(); }
+    size_t Capacity() const { return capacity_; }
+
+    Stats GetStats() const {
+        Stats stats = stats_;
+        stats.entries = entries_.size();
+        stats.capacity = capacity_;
+        stats.keyBytes = keyBytes_;
+        return stats;
+    }
+
+private:
+    using Entry = std::pair<std::string, Value>;
+
+    void EvictOldest() {
+        Entry& oldest = entries_.back();
+        keyBytes_ -= oldest.first.size();
+        index_.erase(oldest.first);
+        entries_.pop_back();
+        ++stats_.evictions;
+    }
+
+    size_t capacity_;
+    size_t keyBytes_ = 0;
+    Stats stats_;
+    std::list<Entry> entries_;
+    std::unordered_map<std::string_view, typename std::list<Entry>::iterator> index_;
+};
+
+} // namespace cll
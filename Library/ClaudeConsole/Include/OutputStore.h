@@ -0,0 +1,57 @@
+#pragma once
+
+#include <string>
+#include <string_view>
+#include "CommandResult.h"
+
+namespace cll {
+
+// How much of a command's output a store keeps
+enum class OutputRetention {
+    All,            // everything, spilling to a file past the threshold
+    Head,           // the first N bytes
+    Tail,           // the last N bytes
+    HeadAndTail     // the first N and the last N bytes
+};
+
+// Collects a command's stdout. Under OutputRetention::All it is kept in
+// memory up to the spill threshold; past it, everything so far and all
+// later output go to an unlinked temp file, which the result then refers to
+// through a mapping. A threshold of zero never spills. The other policies
+// keep at most 2N bytes in memory, the tail in a ring buffer, and report
+// the rest in CommandResult::droppedBytes.
+class OutputStore {
+public:
+    explicit OutputStore(size_t spillThreshold, OutputRetention retention = OutputRetention::All,
+                         size_t retainBytes = 0);
+    ~OutputStore();
+
+    OutputStore(const OutputStore&) = delete;
+    OutputStore& operator=(const OutputStore&) = delete;
+
+    void Append(std::string_view chunk);
+    bool Spilled() const { return fd_ >= 0; }
+    // Bytes appended so far, kept or not
+    size_t Size() const { return size_; }
+
+    // Move the output into result.output or result.spilledOutput; a failed
+    // spill is reported in result.error. With a head and a tail, the output
+    // is the head followed by the tail, and the dropped bytes came between.
+    void Finish(CommandResult& result);
+
+private:
+    bool Spill();
+    void AppendTail(std::string_view chunk);
+
+    size_t threshold_;
+    OutputRetention retention_;
+    size_t retainBytes_;
+    std::string buffer_;        // everything, or the head
+    std::string tail_;          // ring buffer; the oldest byte is at tailStart_
+    size_t tailStart_ = 0;
+    int fd_ = -1;
+    size_t size_ = 0;
+    std::string error_;
+};
+
+} // namespace cll
@@ -0,0 +1,48 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <mutex>
+#include <unordered_map>
+#include <ctime>
+
+namespace cll {
+
+// Index of the executables reachable through PATH, built on first use.
+// Each lookup re-checks PATH and the modification times of its
+// directories, so installing or removing a program rebuilds the index.
+class PathCache {
+public:
+    PathCache() = default;
+
+    PathCache(const PathCache&) = delete;
+    PathCache& operator=(const PathCache&) = delete;
+
+    // Absolute path that PATH resolves a command name to, or "" if none.
+    // Names containing '/' are checked directly.
+    std::string Find(const std::string& name);
+    bool Contains(const std::string& name) { return !Find(name).empty(); }
+
+    // Drop the index so the next lookup rebuilds it ("hash -r")
+    void Invalidate();
+
+    size_t CommandCount();
+    size_t DirectoryCount();
+
+private:
+    struct Directory {
+        std::string path;
+        timespec mtime;
+    };
+
+    void RefreshLocked();
+    bool IsStaleLocked(const std::string& path) const;
+
+    std::mutex mutex_;
+    bool built_ = false;
+    std::string path_;
+    std::vector<Directory> directories_;
+    std::unordered_map<std::string, std::string> commands_;
+};
+
+} // namespace cll
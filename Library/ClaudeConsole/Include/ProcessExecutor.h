@@ -0,0 +1,157 @@
+#pragma once
+
+#include <string>
+#include <string_view>
+#include <vector>
+#include <functional>
+#include <memory>
+#include <sys/resource.h>
+#include <sys/types.h>
+#include "CommandResult.h"
+#include "CancelToken.h"
+#include "ProcessLimits.h"
+
+namespace cll {
+
+// Description of a child process to run
+struct ProcessRequest {
+    using ChunkCallback = std::function<void(std::string_view)>;
+
+    // Program and arguments; argv[0] is looked up in PATH unless it contains '/'
+    std::vector<std::string> argv;
+
+    // Executable to run, when already resolved; argv[0] is still passed as is
+    std::string program;
+
+    // Output sinks; when empty the stream is captured into the result
+    ChunkCallback onStdout;
+    ChunkCallback onStderr;
+
+    // Send stderr down the stdout pipe, like "2>&1"
+    bool mergeStderr = false;
+
+    // Give the child a stdin pipe instead of inheriting ours
+    bool pipeStdin = false;
+
+    // With pipeStdin, bytes Collect writes to that pipe, as the child makes
+    // room, before closing it. They are not copied, so they must stay valid
+    // until Execute or Collect returns.
+    std::string_view stdinData;
+
+    // Descriptors to use as the child's stdio instead of a pipe to us (or,
+    // for stdin, instead of ours); the caller keeps ownership. The matching
+    // ChildProcess descriptor is then -1.
+    int stdinFd = -1;
+    int stdoutFd = -1;
+    int stderrFd = -1;
+
+    // Put the child in a process group of its own, with itself as leader;
+    // interrupts then reach the whole group
+    bool newProcessGroup = false;
+
+    // Join this existing process group instead, such as the one an earlier
+    // pipeline stage leads
+    pid_t processGroup = 0;
+
+    // While it runs, make the child's group the terminal's foreground group
+    // (when our stdin is the terminal), so it can read it and gets Ctrl-C
+    // directly; needs newProcessGroup
+    bool takeTerminal = false;
+
+    // Send SIGTERM once this has passed (zero for no limit), SIGKILL later
+    std::chrono::milliseconds timeout{0};
+
+    // Send SIGINT when this token is cancelled, SIGKILL later
+    const CancelToken* cancel = nullptr;
+
+    // Niceness, affinity, rlimits and cgroup for the child. posix_spawn has
+    // no hook for these, so a limited request spawned locally (without the
+    // spawn server) is started with fork and exec instead.
+    ProcessLimits limits;
+
+    // Build a request that runs a command line through /bin/sh -c
+    static ProcessRequest Shell(const std::string& command);
+};
+
+// A spawned child and the parent's ends of its pipes (-1 when not piped)
+struct ChildProcess {
+    pid_t pid = -1;
+    int stdinFd = -1;
+    int stdoutFd = -1;
+    int stderrFd = -1;
+
+    // Started by the spawn server, which also reaps it
+    bool viaServer = false;
+};
+
+class SpawnServer;
+class PathCache;
+
+// Runs child processes with posix_spawn and separate stdout/stderr pipes.
+// Both pipes are drained with large non-blocking reads, so captured output
+// is binary-safe and CommandResult::error holds the child's real stderr.
+// With StartServer() spawns go through a SpawnServer instead, falling back
+// to a local posix_spawn whenever the server cannot take a request.
+class ProcessExecutor {
+public:
+    static constexpr size_t ReadChunkSize = 64 * 1024;
+    static constexpr int StdinPipeSize = 1 << 20;
+
+    ProcessExecutor();
+    ~ProcessExecutor();
+
+    ProcessExecutor(const ProcessExecutor&) = delete;
+    ProcessExecutor& operator=(const ProcessExecutor&) = delete;
+
+    // Fork the spawn server; call early, before the process grows large
+    bool StartServer();
+    void StopServer();
+    bool UsesServer() const;
+
+    // Resolve bare program names through a PATH index instead of letting
+    // exec search PATH; unknown names then fail without spawning anything
+    void SetPathCache(PathCache* cache) { pathCache_ = cache; }
+
+    // Spawn, drain and reap a process; exit code 127 means it could not be started
+    CommandResult Execute(const ProcessRequest& request);
+
+    // Drain a spawned child's pipes into the request's sinks (or the result),
+    // close them and reap the child; timing is measured from startTime
+    CommandResult Collect(const ProcessRequest& request, ChildProcess& child,
+                          std::chrono::high_resolution_clock::time_point startTime);
+
+    // Start a process and hand its pipes to the caller, who must close them
+    // and reap the pid; returns false with a message in error on failure
+    bool Spawn(const ProcessRequest& request, ChildProcess& child, std::string& error);
+
+    // Block until a spawned child exits and return its shell-style exit
+    // code; usage, when given, receives the child's resource usage
+    int Wait(const ChildProcess& child, rusage* usage = nullptr);
+
+    // Run stages as a pipeline in one new process group, each stage's stdout
+    // feeding the next one's stdin. Boundaries are relayed with splice(), so
+    // bytes are counted without copying them through user space. The last
+    // stage's stdout and every stage's stderr go to options' sinks (or the
+    // result); its timeout, cancel token and takeTerminal apply to the whole
+    // pipeline, and its limits to each stage. The exit code is the last
+    // stage's; result.stages has the per-stage figures.
+    CommandResult ExecutePipeline(const std::vector<std::vector<std::string>>& stages,
+                                  const ProcessRequest& options);
+
+    // Convenience wrapper for a shell command line with captured output
+    CommandResult ExecuteShell(const std::string& command);
+
+    // Translate a waitpid() status into a shell-style exit code
+    static int DecodeWaitStatus(int status);
+
+    // Translate wait4() resource usage for CommandResult
+    static ResourceUsage DecodeResourceUsage(const rusage& usage);
+
+private:
+    bool SpawnLocal(const ProcessRequest& request, ChildProcess& child, std::string& error);
+
+    std::unique_ptr<SpawnServer> server_;
+    PathCache* pathCache_ = nullptr;
+};
+
+} // namespace cll
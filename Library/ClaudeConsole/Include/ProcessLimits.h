@@ -0,0 +1,55 @@
+#pragma once
+
+#include <optional>
+#include <string>
+#include <string_view>
+#include <sched.h>
+#include <sys/resource.h>
+
+namespace cll {
+
+// Scheduling and resource limits for a child, applied after fork and before
+// exec so they hold from the program's first instruction. Zero and empty
+// fields leave the inherited setting alone.
+struct ProcessLimits {
+    // Added to the niceness, as nice -n does
+    int nice = 0;
+
+    // CPUs the child may run on
+    std::optional<cpu_set_t> cpus;
+
+    // RLIMIT_AS in bytes and RLIMIT_CPU in seconds
+    rlim_t addressSpace = 0;
+    rlim_t cpuSeconds = 0;
+
+    // cgroup v2 directory to join; joining is best effort, since creating
+    // and delegating the group is up to the system
+    std::string cgroup;
+
+    bool Empty() const;
+
+    // Take every field that other sets
+    void Merge(const ProcessLimits& other);
+
+    // Parse one "key=value" option: nice=N, cpus=LIST, mem=SIZE (with a
+    // K, M or G suffix), cputime=SECONDS or cgroup=PATH, where a relative
+    // PATH is under /sys/fs/cgroup
+    bool ParseOption(std::string_view option, std::string& error);
+
+    // The options that reproduce these limits, space separated
+    std::string Describe() const;
+
+    // Apply to the calling process. Meant for a freshly forked child of a
+    // threaded parent, so it only makes system calls; failures are written
+    // to stderr. Returns false if one was fatal (anything but the cgroup).
+    bool ApplyToCurrentProcess() const;
+
+    // CPU lists in the kernel's format, such as "0-3,8"
+    static bool ParseCpuList(std::string_view list, cpu_set_t& cpus);
+    static std::string FormatCpuList(const cpu_set_t& cpus);
+};
+
+// Pin the calling thread; threads it creates later inherit the mask
+bool SetThreadAffinity(const cpu_set_t& cpus);
+
+} // namespace cll
@@ -0,0 +1,55 @@
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <string_view>
+
+namespace cll {
+
+// A script file read once into a buffer of its exact size, in a form V8
+// can use in place as an external string instead of copying it into its
+// heap. Pure ASCII, most JavaScript, is used as read; UTF-8 is decoded
+// in one pass to Latin-1 when every character fits, or else to UTF-16.
+class ScriptSource {
+public:
+    enum class Encoding {
+        Latin1,   // Latin1(): the bytes read when ASCII, else decoded
+        Utf16,    // Utf16(): decoded, for characters past U+00FF
+        Invalid,  // not UTF-8: Bytes() for V8 to decode with replacements
+    };
+
+    static std::shared_ptr<const ScriptSource> Open(const std::string& path, std::string& error);
+    // Take over the first size bytes of a buffer already read
+    static std::shared_ptr<const ScriptSource> FromBuffer(std::unique_ptr<char[]> bytes, size_t size);
+
+    ScriptSource(const ScriptSource&) = delete;
+    ScriptSource& operator=(const ScriptSource&) = delete;
+
+    // The file as read, whatever its encoding
+    std::string_view Bytes() const { return {bytes_.get(), size_}; }
+
+    Encoding GetEncoding() const { return encoding_; }
+    std::string_view Latin1() const { return ascii_ ? Bytes() : std::string_view(latin1_); }
+    std::u16string_view Utf16() const { return utf16_; }
+
+    // Whether V8 is given the bytes read, with no decoded copy alongside
+    bool IsAscii() const { return ascii_; }
+
+    // Exposed for tests: decode text, which must be valid UTF-8, into
+    // Latin-1 when every character fits, else UTF-16
+    static Encoding Decode(std::string_view text, std::string& latin1, std::u16string& utf16);
+    static bool IsAsciiText(std::string_view text);
+
+private:
+    ScriptSource() = default;
+
+    std::unique_ptr<char[]> bytes_;
+    size_t size_ = 0;
+    bool ascii_ = false;
+    Encoding encoding_ = Encoding::Invalid;
+    std::string latin1_;
+    std::u16string utf16_;
+};
+
+} // namespace cll
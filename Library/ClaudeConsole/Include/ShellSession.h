@@ -0,0 +1,59 @@
+#pragma once
+
+#include <string>
+#include "CommandResult.h"
+#include "ProcessExecutor.h"
+
+namespace cll {
+
+// A long-lived /bin/sh coprocess for Shell mode. Each command is sent over
+// the shell's stdin and followed by a sentinel line on stdout and stderr, so
+// the end of its output and its exit status can be found without starting a
+// new shell. cd, export and shell functions persist between commands.
+class ShellSession {
+public:
+    using ChunkCallback = ProcessRequest::ChunkCallback;
+
+    explicit ShellSession(ProcessExecutor& executor);
+    ~ShellSession();
+
+    ShellSession(const ShellSession&) = delete;
+    ShellSession& operator=(const ShellSession&) = delete;
+
+    // Start the shell; Execute() does this on demand
+    bool Start(std::string& error);
+    void Stop();
+    bool IsRunning() const { return child_.pid > 0; }
+
+    // Run one command line in the session. Output goes to the sinks, or into
+    // the result when they are empty. Commands read stdin from /dev/null.
+    // If the command ends the shell (exit, exec) the session restarts on the
+    // next call.
+    CommandResult Execute(const std::string& command, const ChunkCallback& onStdout = nullptr,
+                          const ChunkCallback& onStderr = nullptr);
+
+    // Interrupt commands on cancel or after a timeout (zero for none). The
+    // signal goes to the shell's whole process group; the shell traps it,
+    // so only the command stops. A command still running after the grace
+    // period is killed with the shell, and the result says so.
+    void SetCancelToken(const CancelToken* cancel) { cancel_ = cancel; }
+    void SetTimeout(std::chrono::milliseconds timeout) { timeout_ = timeout; }
+
+    // Limits for the shell, and so for every command it runs; they take
+    // effect when the shell next starts
+    void SetLimits(const ProcessLimits& limits) { limits_ = limits; }
+
+    // Quote text as a single shell word
+    static std::string QuoteWord(const std::string& text);
+
+private:
+    ProcessExecutor& executor_;
+    ChildProcess child_;
+    std::string marker_;
+    std::string markerEscaped_;
+    const CancelToken* cancel_ = nullptr;
+    std::chrono::milliseconds timeout_{0};
+    ProcessLimits limits_;
+};
+
+} // namespace cll
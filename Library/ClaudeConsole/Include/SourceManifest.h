@@ -0,0 +1,46 @@
+#pragma once
+
+#include <cstdint>
+#include <iosfwd>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace cll {
+
+// The source files a cached artifact, such as a V8 snapshot, was made
+// from, with a content hash of each. Stored ahead of the artifact so a
+// later session can tell whether any file has changed since.
+class SourceManifest {
+public:
+    struct Entry {
+        std::string path;
+        uint64_t hash;
+    };
+
+    // Record a file as it is now; relative paths are made absolute.
+    // False if it cannot be read.
+    bool Add(const std::string& path);
+
+    const std::vector<Entry>& Entries() const { return entries_; }
+
+    // Whether every file still hashes as recorded
+    bool IsCurrent() const;
+
+    // The manifest as text lines headed by key, which names the artifact
+    // and whatever else it depends on (the V8 version, say). Read leaves
+    // the stream at the first byte after the manifest, and fails if the
+    // key differs or the lines are malformed.
+    void Write(std::ostream& out, std::string_view key) const;
+    bool Read(std::istream& in, std::string_view key);
+
+    // 64-bit FNV-1a: stable across builds and runs, unlike std::hash
+    static uint64_t Hash(std::string_view data);
+    static std::optional<uint64_t> HashFile(const std::string& path);
+
+private:
+    std::vector<Entry> entries_;
+};
+
+} // namespace cll
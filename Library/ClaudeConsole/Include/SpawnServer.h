@@ -0,0 +1,63 @@
+#pragma once
+
+#include <string>
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <thread>
+#include <condition_variable>
+#include <sys/resource.h>
+#include <sys/types.h>
+#include "ProcessExecutor.h"
+
+namespace cll {
+
+// A small helper process (a "zygote") that performs every spawn on behalf of
+// the console. It is forked while the console process is still small, so
+// later forks copy the helper's few megabytes instead of a large V8 heap.
+// Requests travel over a Unix socket with the child's stdio passed as
+// SCM_RIGHTS descriptors. The helper reaps its children via signalfd and
+// sends their exit statuses back.
+class SpawnServer {
+public:
+    SpawnServer() = default;
+    ~SpawnServer();
+
+    SpawnServer(const SpawnServer&) = delete;
+    SpawnServer& operator=(const SpawnServer&) = delete;
+
+    // Fork the helper; call before the process starts threads or grows large
+    bool Start();
+    void Stop();
+    bool IsRunning() const;
+
+    // Ask the helper to start a process; fails if the helper is gone
+    bool Spawn(const ProcessRequest& request, ChildProcess& child, std::string& error);
+
+    // Block until the helper reports that a child it spawned has exited
+    // and return the raw wait status; usage receives its resource usage
+    int Wait(pid_t pid, rusage* usage = nullptr);
+
+private:
+    struct Reply;
+    struct ExitInfo {
+        int status;
+        rusage usage;
+    };
+
+    void ReaderLoop();
+    static void ServerLoop(int socket);
+
+    int socket_ = -1;
+    pid_t serverPid_ = -1;
+    std::thread reader_;
+
+    mutable std::mutex mutex_;
+    std::condition_variable changed_;
+    bool alive_ = false;
+    uint32_t nextRequestId_ = 1;
+    std::map<uint32_t, std::pair<pid_t, int>> spawnReplies_;
+    std::map<pid_t, ExitInfo> exitStatuses_;
+};
+
+} // namespace cll
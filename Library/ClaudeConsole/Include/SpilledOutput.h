@@ -0,0 +1,37 @@
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <ostream>
+#include <string>
+#include <string_view>
+
+namespace cll {
+
+// Command output that outgrew memory, kept in an unlinked temp file and
+// mapped read-only. The file goes away with the last reference.
+class SpilledOutput {
+public:
+    // Map the first size bytes of fd, taking ownership of it
+    static std::shared_ptr<const SpilledOutput> Map(int fd, size_t size, std::string& error);
+    ~SpilledOutput();
+
+    SpilledOutput(const SpilledOutput&) = delete;
+    SpilledOutput& operator=(const SpilledOutput&) = delete;
+
+    std::string_view View() const { return {data_, size_}; }
+    size_t Size() const { return size_; }
+
+    // Write the contents in slices, dropping each slice's pages once written
+    // so printing does not pull the whole file into memory at once
+    void WriteTo(std::ostream& out) const;
+
+private:
+    SpilledOutput(int fd, const char* data, size_t size);
+
+    int fd_;
+    const char* data_;
+    size_t size_;
+};
+
+} // namespace cll
@@ -7,8 +7,13 @@
 
 namespace v8_compat {
 
-// Platform creation wrapper - defined in Source/v8_platform_compat.cpp
-std::unique_ptr<v8::Platform> CreateDefaultPlatform(int thread_pool_size = 0);
+// Platform creation wrapper. Idle tasks are off in V8's default platform;
+// the console runs them while it waits for input.
+inline std::unique_ptr<v8::Platform> CreateDefaultPlatform(
+    int thread_pool_size = 0,
+    v8::platform::IdleTaskSupport idle_task_support = v8::platform::IdleTaskSupport::kEnabled) {
+    return v8::platform::NewDefaultPlatform(thread_pool_size, idle_task_support);
+}
 
 // ScriptOrigin creation wrapper to handle API differences between V8 versions
 inline v8::ScriptOrigin CreateScriptOrigin(
@@ -138,6 +143,31 @@ private:
     v8::TryCatch try_catch_;
 };
 
+// SnapshotCreator takes CreateParams from V8 12 on; the constructor taking
+// only the external references is deprecated there
+inline std::unique_ptr<v8::SnapshotCreator> CreateSnapshotCreator(const intptr_t* external_references) {
+#if V8_MAJOR_VERSION >= 12
+    v8::Isolate::CreateParams params;
+    params.array_buffer_allocator_shared =
+        std::shared_ptr<v8::ArrayBuffer::Allocator>(v8::ArrayBuffer::Allocator::NewDefaultAllocator());
+    params.external_references = external_references;
+    return std::make_unique<v8::SnapshotCreator>(params);
+#else
+    return std::make_unique<v8::SnapshotCreator>(external_references);
+#endif
+}
+
+// StartStreamingScript became StartStreaming, which takes the script type,
+// in V8 10
+inline v8::ScriptCompiler::ScriptStreamingTask* StartStreaming(
+    v8::Isolate* isolate, v8::ScriptCompiler::StreamedSource* source) {
+#if V8_MAJOR_VERSION >= 10
+    return v8::ScriptCompiler::StartStreaming(isolate, source);
+#else
+    return v8::ScriptCompiler::StartStreamingScript(isolate, source);
+#endif
+}
+
 // Context creation with default settings
 inline v8::Local<v8::Context> CreateContext(
     v8::Isolate* isolate,
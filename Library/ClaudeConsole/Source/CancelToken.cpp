@@ -0,0 +1,36 @@
+#include "CancelToken.h"
+#include <fcntl.h>
+#include <unistd.h>
+
+namespace cll {
+
+CancelToken::CancelToken() {
+    int fds[2];
+    if (pipe2(fds, O_CLOEXEC | O_NONBLOCK) == 0) {
+        readFd_ = fds[0];
+        writeFd_ = fds[1];
+    }
+}
+
+CancelToken::~CancelToken() {
+    if (readFd_ >= 0) close(readFd_);
+    if (writeFd_ >= 0) close(writeFd_);
+}
+
+void CancelToken::Cancel() {
+    cancelled_.store(true);
+    if (writeFd_ >= 0) {
+        char byte = 1;
+        ssize_t ignored = write(writeFd_, &byte, 1);
+        (void)ignored;
+    }
+}
+
+void CancelToken::Reset() {
+    cancelled_.store(false);
+    char buffer[64];
+    while (readFd_ >= 0 && read(readFd_, buffer, sizeof(buffer)) > 0) {
+    }
+}
+
+} // namespace cll
@@ -0,0 +1,70 @@
+#pragma once
+
+// Deadline and cancel handling shared by the read loops that wait on children
+#include <algorithm>
+#include <chrono>
+#include <csignal>
+#include <sys/types.h>
+#include "CancelToken.h"
+
+namespace cll {
+
+// Tracks a child's deadline and cancel token. When either fires the child
+// (or its whole process group, for a negative target) gets a polite signal,
+// and SIGKILL if it is still around after KillGracePeriod.
+class ChildInterrupter {
+public:
+    using Clock = std::chrono::steady_clock;
+    static constexpr std::chrono::milliseconds KillGracePeriod{2000};
+
+    ChildInterrupter(pid_t target, std::chrono::milliseconds timeout, const CancelToken* cancel)
+        : target_(target), cancel_(cancel),
+          deadline_(timeout.count() > 0 ? Clock::now() + timeout : Clock::time_point::max()) {}
+
+    // Descriptor to poll for a cancel request, or -1 once it no longer matters
+    int CancelFd() const {
+        return (cancel_ && !Interrupted()) ? cancel_->Fd() : -1;
+    }
+
+    // Milliseconds until the next deadline, or -1 for none
+    int PollTimeout() const {
+        if (deadline_ == Clock::time_point::max()) return -1;
+        auto remaining = std::chrono::ceil<std::chrono::milliseconds>(deadline_ - Clock::now());
+        return static_cast<int>(std::max<std::chrono::milliseconds::rep>(remaining.count(), 0));
+    }
+
+    // Act on passed deadlines and a pending cancel; returns false once the
+    // child has been killed and waiting on its pipes should stop
+    bool Update() {
+        if (!Interrupted() && cancel_ && cancel_->IsCancelled()) {
+            cancelled_ = true;
+            Signal(SIGINT);
+        } else if (Clock::now() >= deadline_) {
+            if (Interrupted()) {
+                kill(target_, SIGKILL);
+                return false;
+            }
+            timedOut_ = true;
+            Signal(SIGTERM);
+        }
+        return true;
+    }
+
+    bool TimedOut() const { return timedOut_; }
+    bool Cancelled() const { return cancelled_; }
+    bool Interrupted() const { return timedOut_ || cancelled_; }
+
+private:
+    void Signal(int signal) {
+        kill(target_, signal);
+        deadline_ = Clock::now() + KillGracePeriod;
+    }
+
+    pid_t target_;
+    const CancelToken* cancel_;
+    Clock::time_point deadline_;
+    bool timedOut_ = false;
+    bool cancelled_ = false;
+};
+
+} // namespace cll
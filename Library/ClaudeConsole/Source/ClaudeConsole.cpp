@@ -1,4 +1,5 @@
 #include "ClaudeConsole.h"
+#include "OutputStore.h"
 #include <iostream>
 #include <sstream>
 #include <algorithm>
@@ -8,9 +9,14 @@
 #include <chrono>
 #include <fstream>
 #include <cctype>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <type_traits>
 
 #ifdef HAS_V8
 #include "DllLoader.h"
+#include "ScriptStreamer.h"
 #include "V8Compat.h"
 #include <libplatform/libplatform.h>
 #endif
@@ -23,14 +29,232 @@ namespace fs = std::filesystem;
 
 namespace cll {
 
+namespace {
+
+// Say why a command stopped early; streamed output has no other trace of it
+void DescribeInterruption(CommandResult& result, std::chrono::milliseconds timeout) {
+    std::string reason;
+    if (result.timedOut) {
+        reason = std::format("Timed out after {}",
+            ClaudeConsole::FormatExecutionTime(std::chrono::duration_cast<std::chrono::microseconds>(timeout)));
+    } else if (result.cancelled) {
+        reason = "Cancelled";
+    } else {
+        return;
+    }
+    if (!result.error.empty() && result.error.back() != '\n') {
+        result.error += '\n';
+    }
+    result.error += reason;
+}
+
+// Byte counts for timing breakdowns, e.g. "512B" or "1.5MB"
+std::string FormatByteCount(uint64_t bytes) {
+    if (bytes < 1024) {
+        return std::format("{}B", bytes);
+    } else if (bytes < 1024 * 1024) {
+        return std::format("{:.1f}KB", bytes / 1024.0);
+    } else if (bytes < 1024ull * 1024 * 1024) {
+        return std::format("{:.1f}MB", bytes / (1024.0 * 1024));
+    } else {
+        return std::format("{:.2f}GB", bytes / (1024.0 * 1024 * 1024));
+    }
+}
+
+// Remove leading and trailing whitespace
+std::string TrimWhitespace(const std::string& text) {
+    size_t start = text.find_first_not_of(" \t\n\r");
+    if (start == std::string::npos) {
+        return "";
+    }
+    size_t end = text.find_last_not_of(" \t\n\r");
+    return text.substr(start, end - start + 1);
+}
+
+// Sets variables in our environment, for children spawned meanwhile to
+// inherit, and removes them again when it goes out of scope
+class ScopedEnvironment {
+public:
+    ScopedEnvironment() = default;
+    ScopedEnvironment(const ScopedEnvironment&) = delete;
+    ScopedEnvironment& operator=(const ScopedEnvironment&) = delete;
+
+    ~ScopedEnvironment() {
+        for (const auto& name : names_) {
+            unsetenv(name.c_str());
+        }
+    }
+
+    void Set(const ClaudeConsole::SubstitutionVariables& variables) {
+        for (const auto& [name, value] : variables) {
+            setenv(name.c_str(), value.c_str(), 1);
+            names_.push_back(name);
+        }
+    }
+
+private:
+    std::vector<std::string> names_;
+};
+
+#ifdef HAS_V8
+// Terminates a running script when it passes its deadline or the console's
+// cancel token fires; V8 allows TerminateExecution from any thread. It
+// keeps terminating until stopped, so no later script in its scope runs on.
+class ScriptWatchdog {
+public:
+    ScriptWatchdog(v8::Isolate* isolate, std::chrono::milliseconds timeout, const CancelToken& cancel)
+        : isolate_(isolate), timeout_(timeout), cancel_(cancel), thread_([this] { Run(); }) {}
+
+    ~ScriptWatchdog() {
+        Stop();
+    }
+
+    void Stop() {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            stopped_ = true;
+        }
+        changed_.notify_all();
+        if (thread_.joinable()) {
+            thread_.join();
+        }
+    }
+
+    bool TimedOut() const { return timedOut_; }
+    bool Cancelled() const { return cancelled_; }
+
+private:
+    void Run() {
+        auto deadline = std::chrono::steady_clock::now() + timeout_;
+        std::unique_lock<std::mutex> lock(mutex_);
+        while (!stopped_) {
+            // The cancel token is signal-driven, so check it on a short tick
+            changed_.wait_for(lock, std::chrono::milliseconds(50));
+            if (stopped_) break;
+            if (timedOut_ || cancelled_) {
+                // Already fired
+            } else if (cancel_.IsCancelled()) {
+                cancelled_ = true;
+            } else if (timeout_.count() > 0 && std::chrono::steady_clock::now() >= deadline) {
+                timedOut_ = true;
+            } else {
+                continue;
+            }
+            isolate_->TerminateExecution();
+        }
+    }
+
+    v8::Isolate* isolate_;
+    std::chrono::milliseconds timeout_;
+    const CancelToken& cancel_;
+    std::mutex mutex_;
+    std::condition_variable changed_;
+    bool stopped_ = false;
+    bool timedOut_ = false;
+    bool cancelled_ = false;
+    std::thread thread_;
+};
+
+// Arms a ScriptWatchdog unless one already covers the running JavaScript,
+// so every way into a script (tasks, microtasks, background loads, files)
+// can be stopped, and a script run from another is watched only once.
+// When it stops a script it clears the termination and passes the reason
+// to report, if given.
+class WatchdogScope {
+public:
+    using Report = std::function<void(const std::string&)>;
+
+    WatchdogScope(bool& watched, v8::Isolate* isolate, std::chrono::milliseconds timeout, CancelToken& cancel,
+                  Report report = nullptr)
+        : watched_(watched), isolate_(isolate), timeout_(timeout), report_(std::move(report)) {
+        if (watched_) return;
+        // As with a command, a Ctrl-C from before it started is not for it
+        cancel.Reset();
+        watched_ = true;
+        watchdog_.emplace(isolate, timeout, cancel);
+    }
+
+    ~WatchdogScope() {
+        Stop();
+    }
+
+    void Stop() {
+        if (!watchdog_) return;
+        watchdog_->Stop();
+        timedOut_ = watchdog_->TimedOut();
+        cancelled_ = watchdog_->Cancelled();
+        watchdog_.reset();
+        watched_ = false;
+        if (!timedOut_ && !cancelled_) return;
+
+        // Also clears a termination that landed after the script finished
+        isolate_->CancelTerminateExecution();
+        if (report_) {
+            CommandResult result{};
+            result.timedOut = timedOut_;
+            result.cancelled = cancelled_;
+            DescribeInterruption(result, timeout_);
+            report_(result.error + "\n");
+        }
+    }
+
+    bool TimedOut() const { return timedOut_; }
+    bool Cancelled() const { return cancelled_; }
+
+private:
+    bool& watched_;
+    v8::Isolate* isolate_;
+    std::chrono::milliseconds timeout_;
+    Report report_;
+    std::optional<ScriptWatchdog> watchdog_;
+    bool timedOut_ = false;
+    bool cancelled_ = false;
+};
+
+// Lets a JS string read spilled output straight from its mapping; V8
+// disposes of the resource, and so drops the mapping, when the string dies
+class SpilledOutputResource : public v8::String::ExternalOneByteStringResource {
+public:
+    explicit SpilledOutputResource(std::shared_ptr<const SpilledOutput> output)
+        : output_(std::move(output)) {}
+
+    const char* data() const override { return output_->View().data(); }
+    size_t length() const override { return output_->Size(); }
+
+private:
+    std::shared_ptr<const SpilledOutput> output_;
+};
+
+// A command's output as a JS string. Spilled ASCII output is wrapped
+// without copying; anything else has to be decoded from UTF-8.
+v8::MaybeLocal<v8::String> NewOutputString(v8::Isolate* isolate, const CommandResult& result) {
+    std::string_view output = result.OutputView();
+    if (result.spilledOutput && output.size() <= static_cast<size_t>(v8::String::kMaxLength) &&
+        std::all_of(output.begin(), output.end(), [](char c) { return (c & 0x80) == 0; })) {
+        return v8::String::NewExternalOneByte(isolate, new SpilledOutputResource(result.spilledOutput));
+    }
+    if (output.size() > static_cast<size_t>(v8::String::kMaxLength)) {
+        return {};
+    }
+    return v8::String::NewFromUtf8(isolate, output.data(), v8::NewStringType::kNormal,
+                                   static_cast<int>(output.size()));
+}
+#endif
+
+} // namespace
+
 #ifdef HAS_V8
 // Static instance for V8 callbacks
 ClaudeConsole* ClaudeConsole::instance_ = nullptr;
 #endif
 
 ClaudeConsole::ClaudeConsole()
-    : mode_(ConsoleMode::Shell), multiLineMode_(MultiLineMode::None),
-      promptFormat_("❯ [{mode}] "), claudePrompt_("? "), claudePromptColor_("orange")
+    : mode_(ConsoleMode::Shell), multiLineMode_(MultiLineMode::None), streamingOutput_(false),
+      persistentShell_(false),
+      promptFormat_("❯ [{mode}] "), claudePrompt_("? "), claudePromptColor_("orange"),
+      shellTimeout_(0), javaScriptTimeout_(0), askTimeout_(std::chrono::seconds(30)),
+      outputSpillThreshold_(DefaultOutputSpillThreshold), outputRetention_(OutputRetention::All),
+      outputRetainBytes_(DefaultOutputRetainBytes), jobs_(executor_)
 #ifdef HAS_V8
       , platform_(nullptr), isolate_(nullptr)
 #endif
@@ -56,6 +280,26 @@ ClaudeConsole::ClaudeConsole()
         {"config", "Manage configuration and aliases"},
         {"reload", "Reload configuration from files"}
     };
+    
+    // Job control, for Shell lines only
+    jobCommands_ = {
+        {"jobs", "List background jobs"},
+        {"fg", "Wait for a background job and show its result"},
+        {"bg", "Resume a stopped background job"},
+        {"wait", "Wait for background jobs to finish"}
+    };
+    
+    // Shell builtins answered without starting a process
+    nativeBuiltins_ = {
+        {"cd", &ClaudeConsole::BuiltinCd},
+        {"pwd", &ClaudeConsole::BuiltinPwd},
+        {"export", &ClaudeConsole::BuiltinExport},
+        {"echo", &ClaudeConsole::BuiltinEcho},
+        {"env", &ClaudeConsole::BuiltinEnv},
+        {"which", &ClaudeConsole::BuiltinWhich},
+        {"hash", &ClaudeConsole::BuiltinHash}
+    };
+    executor_.SetPathCache(&pathCache_);
 }
 
 ClaudeConsole::~ClaudeConsole() {
@@ -63,28 +307,82 @@ ClaudeConsole::~ClaudeConsole() {
 }
 
 bool ClaudeConsole::Initialize() {
+    // Fork the spawn server while the process is still small and has no
+    // V8 threads; commands then spawn from it instead of from this process.
+    // If it cannot start, commands are spawned directly.
+    executor_.StartServer();
+    
+    // V8 waits for the first JavaScript; see EnsureJavaScript()
+    return true;
+}
+
+void ClaudeConsole::WarmUpJavaScript() {
+#ifdef HAS_V8
+    std::lock_guard<std::mutex> lock(javaScriptMutex_);
+    if (warmUpThread_.joinable() || isolate_ || platform_) return;
+    warmUpThread_ = std::thread([this] {
+        // The platform's workers inherit this thread's affinity
+        if (javaScriptWorkerCpus_) {
+            SetThreadAffinity(*javaScriptWorkerCpus_);
+        }
+        platform_ = StartV8Platform();
+    });
+#endif
+}
+
+bool ClaudeConsole::IsJavaScriptReady() const {
 #ifdef HAS_V8
+    return isolate_ != nullptr;
+#else
+    return false;
+#endif
+}
+
+bool ClaudeConsole::EnsureJavaScript() {
+#ifdef HAS_V8
+    if (isolate_) return true;
+    
+    std::thread warmUp;
+    {
+        std::lock_guard<std::mutex> lock(javaScriptMutex_);
+        warmUp = std::move(warmUpThread_);
+    }
+    if (warmUp.joinable()) {
+        warmUp.join();
+    }
+    if (!platform_) {
+        // The platform's worker threads take the affinity of the thread that
+        // starts them, so start them on their own CPUs and move back after
+        cpu_set_t replCpus;
+        bool pinWorkers = javaScriptWorkerCpus_ && sched_getaffinity(0, sizeof(replCpus), &replCpus) == 0 &&
+                          SetThreadAffinity(*javaScriptWorkerCpus_);
+        platform_ = StartV8Platform();
+        if (pinWorkers) {
+            SetThreadAffinity(replCpus);
+        }
+    }
+    
     // Set static instance for callbacks
     instance_ = this;
     
-    // Initialize V8 platform
-    v8::V8::InitializeICUDefaultLocation("");
-    v8::V8::InitializeExternalStartupData("");
-    platform_ = v8_compat::CreateDefaultPlatform();
-    v8::V8::InitializePlatform(platform_.get());
-    v8::V8::Initialize();
-    
-    // Create a new Isolate
+    // The isolate is made here rather than by the warm-up thread: its stack
+    // limit belongs to the thread that creates it
     v8::Isolate::CreateParams create_params;
     create_params.array_buffer_allocator = 
         v8::ArrayBuffer::Allocator::NewDefaultAllocator();
+    usesInitSnapshot_ = initSnapshot_ && LoadInitSnapshot();
+    usesStartupSnapshot_ = usesInitSnapshot_ || LoadStartupSnapshot();
+    if (usesStartupSnapshot_) {
+        create_params.snapshot_blob = &snapshotBlob_;
+        create_params.external_references = ExternalReferences();
+    }
     isolate_ = v8::Isolate::New(create_params);
     
     if (!isolate_) {
         return false;
     }
     
-    // Create V8 context
+    // Create V8 context; from a snapshot it comes with the builtins
     {
         v8::Isolate::Scope isolate_scope(isolate_);
         v8::HandleScope handle_scope(isolate_);
@@ -92,54 +390,68 @@ bool ClaudeConsole::Initialize() {
         v8::Local<v8::Context> context = v8::Context::New(isolate_);
         context_.Reset(isolate_, context);
         
-        // Enter context scope before registering builtins
-        v8::Context::Scope context_scope(context);
-        
-        // Register built-in functions
-        RegisterBuiltins(context);
+        if (!usesStartupSnapshot_) {
+            // Enter context scope before registering builtins
+            v8::Context::Scope context_scope(context);
+            RegisterBuiltins(isolate_, context);
+        }
     }
     
     // Initialize DLL loader
     dllLoader_ = std::make_unique<DllLoader>();
-#endif
     
+    // Without its snapshot, init.js is run the slow way
+    std::string initScript = InitScriptPath();
+    if (!usesInitSnapshot_ && fs::exists(initScript)) {
+        ExecuteFile(initScript);
+    }
     return true;
+#else
+    return false;
+#endif
 }
 
 void ClaudeConsole::Shutdown() {
+    shellSession_.reset();
+    jobs_.TerminateAll();
+    executor_.StopServer();
+    
 #ifdef HAS_V8
-    if (!isolate_) return;
+    if (warmUpThread_.joinable()) {
+        warmUpThread_.join();
+    }
     
     // Clean up V8
-    context_.Reset();
-    isolate_->Dispose();
-    isolate_ = nullptr;
-    v8::V8::Dispose();
+    if (isolate_) {
+        // Streaming tasks must finish before their isolate goes
+        backgroundLoads_.clear();
+        scriptCache_.Clear();
+        context_.Reset();
+        isolate_->Dispose();
+        isolate_ = nullptr;
+    }
+    if (platform_) {
+        v8::V8::Dispose();
+        platform_.reset();
+    }
     
     // Clear instance
-    instance_ = nullptr;
+    if (instance_ == this) {
+        instance_ = nullptr;
+    }
 #endif
 }
 
 CommandResult ClaudeConsole::ExecuteCommand(const std::string& command) {
+    // A Ctrl-C that arrived between commands is not meant for this one
+    cancel_.Reset();
+    
     if (command.empty()) {
         return {true, "", "", std::chrono::microseconds(0), 0};
     }
     
     // Trim whitespace for consistent command handling
-    std::string trimmed = command;
-    // Remove leading whitespace
-    size_t start = trimmed.find_first_not_of(" \t\n\r");
-    if (start != std::string::npos) {
-        trimmed = trimmed.substr(start);
-    } else {
-        trimmed.clear();
-    }
-    // Remove trailing whitespace
-    size_t end = trimmed.find_last_not_of(" \t\n\r");
-    if (end != std::string::npos) {
-        trimmed = trimmed.substr(0, end + 1);
-    }
+    std::string trimmed = TrimWhitespace(command);
     
     if (trimmed.empty()) {
         return {true, "", "", std::chrono::microseconds(0), 0};
@@ -162,49 +474,6 @@ CommandResult ClaudeConsole::ExecuteCommand(const std::string& command) {
         return {true, "Switched to Ask mode", "", std::chrono::microseconds(0), 0};
     }
     
-    // Check for command substitution with backticks `cmd`
-    size_t backtickStart = 0;
-    std::string processed = trimmed;
-    
-    while ((backtickStart = processed.find('`', backtickStart)) != std::string::npos) {
-        size_t backtickEnd = processed.find('`', backtickStart + 1);
-        if (backtickEnd == std::string::npos) {
-            break; // No closing backtick found
-        }
-        
-        std::string shellCommand = processed.substr(backtickStart + 1, backtickEnd - backtickStart - 1);
-        
-        // Execute the shell command and capture output
-        FILE* pipe = popen((shellCommand + " 2>&1").c_str(), "r");
-        if (pipe == nullptr) {
-            return {false, "Failed to execute command: " + shellCommand, "", std::chrono::microseconds(0), 1};
-        }
-        
-        std::string output;
-        char buffer[128];
-        while (fgets(buffer, sizeof(buffer), pipe) != nullptr) {
-            output += buffer;
-        }
-        pclose(pipe);
-        
-        // Remove trailing newline if present
-        if (!output.empty() && output.back() == '\n') {
-            output.pop_back();
-        }
-        
-        // Replace the `cmd` with the output
-        processed.replace(backtickStart, backtickEnd - backtickStart + 1, output);
-        backtickStart += output.length();
-    }
-    
-    // If command substitution occurred, process the result
-    if (processed != trimmed) {
-        if (processed.empty()) {
-            return {true, "", "", std::chrono::microseconds(0), 0};
-        }
-        return ExecuteCommand(processed);
-    }
-    
     // Check for command prefixes
     if (!trimmed.empty()) {
         char prefix = trimmed[0];
@@ -299,7 +568,22 @@ CommandResult ClaudeConsole::ExecuteJavaScript(const std::string& code) {
     
     CommandResult result;
 #ifdef HAS_V8
-    result.success = ExecuteString(code, "<repl>");
+    if (EnsureJavaScript()) {
+        WatchdogScope watchdog(scriptWatched_, isolate_, javaScriptTimeout_, cancel_);
+        result.success = ExecuteString(code, "<repl>");
+        // Under the watchdog too: a task may call back into JavaScript
+        PumpMessageLoop();
+        watchdog.Stop();
+        
+        result.timedOut = watchdog.TimedOut();
+        result.cancelled = watchdog.Cancelled();
+        if (result.timedOut || result.cancelled) {
+            result.success = false;
+            DescribeInterruption(result, javaScriptTimeout_);
+        }
+    } else {
+        result.success = false;
+    }
 #else
     // Simulate JavaScript execution when V8 is not available
     result.success = true;
@@ -318,33 +602,345 @@ CommandResult ClaudeConsole::ExecuteAsk(const std::string& question) {
     return ExecuteClaudeQuery(question);
 }
 
-CommandResult ClaudeConsole::ExecuteShellCommand(const std::string& command) {
-    auto startTime = std::chrono::high_resolution_clock::now();
+CommandResult ClaudeConsole::ExecuteShellCommand(const std::string& line) {
+    auto words = SplitCommand(line);
+    if (!words.empty() && jobCommands_.count(words[0])) {
+        return ExecuteJobCommand(words);
+    }
     
-    // Execute shell command
-    FILE* pipe = popen((command + " 2>&1").c_str(), "r");
-    if (!pipe) {
-        return {false, "", "Failed to execute command", std::chrono::microseconds(0), 127};
+    // Run `cmd` and $(cmd) substitutions, all at once, then carry on with
+    // the line, which reads their output from the environment. The persistent
+    // shell expands them itself, with its own directory and variables.
+    std::string command = line;
+    SubstitutionVariables variables;
+    ScopedEnvironment environment;
+    if (!persistentShell_ && ExpandSubstitutions(line, command, variables)) {
+        environment.Set(variables);
+        if (cancel_.IsCancelled()) {
+            CommandResult result{false, "", "", std::chrono::microseconds(0), 130};
+            result.cancelled = true;
+            DescribeInterruption(result, shellTimeout_);
+            return result;
+        }
+        
+        command = TrimWhitespace(command);
+        if (command.empty()) {
+            return {true, "", "", std::chrono::microseconds(0), 0};
+        }
     }
     
-    std::string output;
-    char buffer[256];
-    while (fgets(buffer, sizeof(buffer), pipe)) {
-        output += buffer;
+    if (IsBackgroundCommand(command)) {
+        return StartBackgroundJob(command.substr(0, command.find_last_of('&')));
     }
     
-    int exitCode = pclose(pipe);
-    auto endTime = std::chrono::high_resolution_clock::now();
+    if (streamingOutput_) {
+        // Output goes to the console as it comes and is also kept for $_
+        OutputStore store(outputSpillThreshold_, outputRetention_, outputRetainBytes_);
+        CommandResult result = ExecuteShellCommand(command,
+            [this, &store](std::string_view chunk) {
+                Output(std::string(chunk));
+                store.Append(chunk);
+            },
+            [this](std::string_view chunk) { Error(std::string(chunk)); });
+        lastResult_ = result;
+        store.Finish(lastResult_);
+        return result;
+    }
     
-    CommandResult result;
-    result.success = (WEXITSTATUS(exitCode) == 0);
-    result.output = output;
-    result.exitCode = WEXITSTATUS(exitCode);
-    result.executionTime = std::chrono::duration_cast<std::chrono::microseconds>(endTime - startTime);
+    return CaptureShellCommand(command);
+}
+
+CommandResult ClaudeConsole::CaptureShellCommand(const std::string& command, std::optional<std::string_view> input,
+                                                 const ProcessLimits* limits) {
+    OutputStore store(outputSpillThreshold_, outputRetention_, outputRetainBytes_);
+    CommandResult result = ExecuteShellCommand(command,
+        [&store](std::string_view chunk) { store.Append(chunk); }, nullptr, input, limits);
+    store.Finish(result);
+    lastResult_ = result;
+    return result;
+}
+
+CommandResult ClaudeConsole::ExecuteShellCommand(const std::string& command, const ChunkCallback& onChunk,
+                                                 const ChunkCallback& onErrorChunk,
+                                                 std::optional<std::string_view> input,
+                                                 const ProcessLimits* limits) {
+    std::string fedCommand;
+    if (!input && SplitStdinFeed(command, fedCommand)) {
+        // lastResult_ is only replaced once this returns, so its output
+        // can be fed in place
+        return ExecuteShellCommand(fedCommand, onChunk, onErrorChunk, lastResult_.OutputView(), limits);
+    }
+    
+    ProcessLimits prefixLimits = limits ? *limits : ProcessLimits{};
+    std::string limitedCommand, limitError;
+    if (SplitLimitPrefix(command, prefixLimits, limitedCommand, limitError)) {
+        if (!limitError.empty()) {
+            CommandResult result{false, "", limitError, std::chrono::microseconds(0), 2};
+            if (onErrorChunk) {
+                onErrorChunk(result.error + "\n");
+                result.error.clear();
+            }
+            return result;
+        }
+        return ExecuteShellCommand(limitedCommand, onChunk, onErrorChunk, input, &prefixLimits);
+    }
+    
+    // The session's stdin carries its script and it runs under the limits it
+    // was started with, so neither can be changed for one command; a fresh
+    // shell would lose the session's directory, variables and functions
+    if (persistentShell_ && (input || limits)) {
+        CommandResult result{false, "", std::format("{} not available with the persistent shell",
+                                                    input ? "Stdin feeds are" : "Per-command limits are"),
+                             std::chrono::microseconds(0), 2};
+        if (onErrorChunk) {
+            onErrorChunk(result.error + "\n");
+            result.error.clear();
+        }
+        return result;
+    }
+    
+    CommandResult builtin;
+    if (!limits && TryNativeBuiltin(command, builtin)) {
+        if (onChunk && !builtin.output.empty()) {
+            onChunk(builtin.output);
+            builtin.output.clear();
+        }
+        if (onErrorChunk && !builtin.error.empty()) {
+            onErrorChunk(builtin.error + "\n");
+            builtin.error.clear();
+        }
+        return builtin;
+    }
+    
+    auto lookupStart = std::chrono::high_resolution_clock::now();
+    if (IsUnknownCommand(command)) {
+        std::string name = SplitCommand(command)[0];
+        CommandResult result{false, "", std::format("{}: command not found", name),
+                             std::chrono::microseconds(0), 127};
+        if (onErrorChunk) {
+            onErrorChunk(result.error + "\n");
+            result.error.clear();
+        }
+        result.executionTime = std::chrono::ceil<std::chrono::microseconds>(
+            std::chrono::high_resolution_clock::now() - lookupStart);
+        return result;
+    }
+    
+    // Simple pipelines skip the shell and report per-stage figures
+    std::vector<std::vector<std::string>> stages;
+    if (!input && IsNativePipeline(command, stages)) {
+        ProcessRequest options;
+        options.onStdout = onChunk;
+        options.onStderr = onErrorChunk;
+        options.takeTerminal = true;
+        options.timeout = shellTimeout_;
+        options.cancel = &cancel_;
+        options.limits = EffectiveLimits(limits);
+        CommandResult result = executor_.ExecutePipeline(stages, options);
+        DescribeInterruption(result, shellTimeout_);
+        return result;
+    }
+    
+    if (persistentShell_) {
+        if (!shellSession_) {
+            shellSession_ = std::make_unique<ShellSession>(executor_);
+            shellSession_->SetCancelToken(&cancel_);
+            shellSession_->SetTimeout(shellTimeout_);
+            shellSession_->SetLimits(EffectiveLimits());
+        }
+        CommandResult result = shellSession_->Execute(command, onChunk, onErrorChunk);
+        DescribeInterruption(result, shellTimeout_);
+        return result;
+    }
     
+    // The command gets its own process group (and the terminal, if we have
+    // one) so Ctrl-C and timeouts reach everything it started
+    ProcessRequest request = ProcessRequest::Shell(command);
+    // Simple lines run the program itself rather than /bin/sh -c
+    std::vector<std::string> argv;
+    if (IsDirectCommand(command, argv)) {
+        request.argv = std::move(argv);
+    }
+    request.onStdout = onChunk;
+    request.onStderr = onErrorChunk;
+    if (input) {
+        request.pipeStdin = true;
+        request.stdinData = *input;
+    }
+    request.newProcessGroup = true;
+    request.takeTerminal = true;
+    request.timeout = shellTimeout_;
+    request.cancel = &cancel_;
+    request.limits = EffectiveLimits(limits);
+    CommandResult result = executor_.Execute(request);
+    DescribeInterruption(result, shellTimeout_);
     return result;
 }
 
+ProcessLimits ClaudeConsole::EffectiveLimits(const ProcessLimits* extra) const {
+    ProcessLimits limits;
+    // Commands get back the CPUs the REPL was moved off
+    if (replCpus_) {
+        limits.cpus = processCpus_;
+    }
+    limits.Merge(commandLimits_);
+    if (extra) {
+        limits.Merge(*extra);
+    }
+    return limits;
+}
+
+void ClaudeConsole::SetCommandLimits(const ProcessLimits& limits) {
+    commandLimits_ = limits;
+    if (shellSession_) {
+        shellSession_->SetLimits(EffectiveLimits());
+    }
+}
+
+bool ClaudeConsole::SetReplCpus(const cpu_set_t& cpus) {
+    // Remember what the process had, for the commands, before the first pin
+    if (!replCpus_ && sched_getaffinity(0, sizeof(processCpus_), &processCpus_) != 0) {
+        return false;
+    }
+    if (!SetThreadAffinity(cpus)) {
+        return false;
+    }
+    replCpus_ = cpus;
+    if (shellSession_) {
+        shellSession_->SetLimits(EffectiveLimits());
+    }
+    return true;
+}
+
+void ClaudeConsole::SetOutputRetention(OutputRetention retention, size_t bytes) {
+    outputRetention_ = retention;
+    outputRetainBytes_ = bytes;
+}
+
+void ClaudeConsole::SetShellTimeout(std::chrono::milliseconds timeout) {
+    shellTimeout_ = timeout;
+    if (shellSession_) {
+        shellSession_->SetTimeout(timeout);
+    }
+}
+
+bool ClaudeConsole::IsBackgroundCommand(const std::string& command) {
+    size_t end = command.find_last_not_of(" \t");
+    if (end == std::string::npos || end == 0 || command[end] != '&') {
+        return false;
+    }
+    // "a &&" is an unfinished list and "\&" a literal ampersand
+    char before = command[end - 1];
+    return before != '&' && before != '\\';
+}
+
+CommandResult ClaudeConsole::StartBackgroundJob(const std::string& command) {
+    // Jobs run apart from the session, so they would not see its state
+    if (persistentShell_) {
+        return {false, "", "Background jobs are not available with the persistent shell",
+                std::chrono::microseconds(0), 2};
+    }
+    
+    JobInfo job;
+    std::string error;
+    ProcessLimits limits;
+    std::string limitedCommand;
+    bool limited = SplitLimitPrefix(command, limits, limitedCommand, error);
+    if (!error.empty()) {
+        return {false, "", error, std::chrono::microseconds(0), 2};
+    }
+    if (!jobs_.Start(limited ? limitedCommand : command, job, error, EffectiveLimits(&limits))) {
+        return {false, "", error, std::chrono::microseconds(0), 127};
+    }
+    return {true, std::format("[{}] {}", job.id, job.pid), "", std::chrono::microseconds(0), 0};
+}
+
+std::string ClaudeConsole::FormatJobReport(const JobReport& report) {
+    const CommandResult& result = report.result;
+    std::string status = result.success ? "Done" : std::format("Exit {}", result.exitCode);
+    std::string text = std::format("[{}]  {}  {}  ({})\n", report.id, status, report.command,
+                                   FormatExecutionTime(result.executionTime));
+    for (const std::string* tail : {&result.output, &result.error}) {
+        if (tail->empty()) continue;
+        text += *tail;
+        if (tail->back() != '\n') {
+            text += '\n';
+        }
+    }
+    return text;
+}
+
+CommandResult ClaudeConsole::ExecuteJobCommand(const std::vector<std::string>& words) {
+    const std::string& cmd = words[0];
+    
+    // Jobs are named "%n" or "n"; the default is the most recent one
+    int id = jobs_.Current();
+    if (words.size() > 1) {
+        std::string spec = words[1];
+        if (!spec.empty() && spec[0] == '%') {
+            spec.erase(0, 1);
+        }
+        id = std::atoi(spec.c_str());
+    }
+    
+    if (cmd == "jobs") {
+        std::string listing;
+        for (const auto& job : jobs_.List()) {
+            listing += std::format("[{}]  {:<8} {}\n", job.id, job.done ? "Done" : "Running", job.command);
+        }
+        return {true, listing, "", std::chrono::microseconds(0), 0};
+    }
+    
+    if (cmd == "wait" && words.size() == 1) {
+        CommandResult result{true, "", "", std::chrono::microseconds(0), 0};
+        for (const auto& job : jobs_.List()) {
+            JobReport report;
+            if (!jobs_.Wait(job.id, report, &cancel_)) continue;
+            if (report.result.cancelled) {
+                // The jobs carry on; only the wait stops
+                result.exitCode = report.result.exitCode;
+                result.cancelled = true;
+                DescribeInterruption(result, shellTimeout_);
+                break;
+            }
+            result.output += FormatJobReport(report);
+            result.exitCode = report.result.exitCode;
+        }
+        result.success = (result.exitCode == 0);
+        return result;
+    }
+    
+    if (id <= 0) {
+        return {false, "", cmd + ": no current job", std::chrono::microseconds(0), 1};
+    }
+    
+    if (cmd == "bg") {
+        for (const auto& job : jobs_.List()) {
+            if (job.id == id && jobs_.Continue(id)) {
+                return {true, std::format("[{}] {} &", job.id, job.command), "", std::chrono::microseconds(0), 0};
+            }
+        }
+        return {false, "", std::format("bg: %{}: no such job", id), std::chrono::microseconds(0), 1};
+    }
+    
+    // fg and wait with a job: block until it finishes and show its result.
+    // Ctrl-C interrupts a job in the foreground, but only the wait for one.
+    JobReport report;
+    bool found = (cmd == "fg") ? jobs_.Foreground(id, report, &cancel_) : jobs_.Wait(id, report, &cancel_);
+    if (!found) {
+        return {false, "", std::format("{}: %{}: no such job", cmd, id), std::chrono::microseconds(0), 1};
+    }
+    DescribeInterruption(report.result, shellTimeout_);
+    return report.result;
+}
+
+void ClaudeConsole::SetPersistentShell(bool enabled) {
+    persistentShell_ = enabled;
+    if (!enabled) {
+        shellSession_.reset();
+    }
+}
+
 CommandResult ClaudeConsole::ExecuteClaudeQuery(const std::string& question) {
     auto startTime = std::chrono::high_resolution_clock::now();
     
@@ -386,17 +982,11 @@ CommandResult ClaudeConsole::ExecuteClaudeQuery(const std::string& question) {
         result.output += "Type 'help' for console commands or try asking me something!";
     } else {
         // Try to find PyClaudeCli or 'ask' command as fallback
-        FILE* checkPipe = popen("which ask 2>/dev/null", "r");
-        if (checkPipe) {
-            char buffer[256];
-            bool hasAsk = (fgets(buffer, sizeof(buffer), checkPipe) != nullptr);
-            pclose(checkPipe);
-            
-            if (hasAsk) {
-                // Execute ask command with the question
-                std::string askCommand = "ask \"" + question + "\" 2>&1";
-                return ExecuteSubprocess(askCommand);
-            }
+        bool hasAsk = pathCache_.Contains("ask");
+        if (hasAsk) {
+            // Execute ask command with the question
+            std::string askCommand = "ask \"" + question + "\" 2>&1";
+            return ExecuteSubprocess(askCommand, askTimeout_);
         }
         
         // Default response for unknown questions
@@ -411,33 +1001,20 @@ CommandResult ClaudeConsole::ExecuteClaudeQuery(const std::string& question) {
     return result;
 }
 
-CommandResult ClaudeConsole::ExecuteSubprocess(const std::string& command) {
-    auto startTime = std::chrono::high_resolution_clock::now();
-    
-    FILE* pipe = popen(command.c_str(), "r");
-    if (!pipe) {
-        return {false, "", "Failed to execute command", std::chrono::microseconds(0), 1};
-    }
-    
-    std::string output;
-    char buffer[4096];
-    while (fgets(buffer, sizeof(buffer), pipe)) {
-        output += buffer;
-    }
-    
-    int exitCode = pclose(pipe);
-    auto endTime = std::chrono::high_resolution_clock::now();
-    
-    CommandResult result;
-    result.success = (WEXITSTATUS(exitCode) == 0);
-    result.output = output;
-    result.exitCode = WEXITSTATUS(exitCode);
-    result.executionTime = std::chrono::duration_cast<std::chrono::microseconds>(endTime - startTime);
-    
-    if (!result.success && !output.empty()) {
-        result.error = output;
-        result.output = "";
+CommandResult ClaudeConsole::ExecuteSubprocess(const std::string& command, std::chrono::milliseconds timeout) {
+    ProcessRequest request = ProcessRequest::Shell(command);
+    request.newProcessGroup = true;
+    request.timeout = timeout;
+    request.cancel = &cancel_;
+    request.limits = EffectiveLimits();
+    CommandResult result = executor_.Execute(request);
+    
+    // Commands that merge their own stderr ("2>&1") report failures on stdout
+    if (!result.success && result.error.empty() && !result.output.empty()) {
+        result.error = std::move(result.output);
+        result.output.clear();
     }
+    DescribeInterruption(result, timeout);
     
     return result;
 }
@@ -468,6 +1045,16 @@ CommandResult ClaudeConsole::ExecuteBuiltinCommand(const std::string& command) {
         result.output += "\nSpecial features:\n";
         result.output += "  &<javascript> - Execute JavaScript from shell mode (e.g., &Math.sqrt(16))\n";
         result.output += "  ?<question> - Ask Claude AI a question (e.g., ?what is capital of canada)\n";
+        result.output += "  <command> & - Run a shell command as a background job\n";
+        result.output += "\nJob control (shell mode):\n";
+        for (const auto& [name, desc] : jobCommands_) {
+            result.output += std::format("  {} - {}\n", name, desc);
+        }
+        result.output += "\nShell builtins (run inside cll):";
+        for (const auto& [name, handler] : nativeBuiltins_) {
+            result.output += " " + name;
+        }
+        result.output += "\n";
         result.output += "\nCurrent mode: " + std::string(mode_ == ConsoleMode::JavaScript ? "JavaScript" : "Shell");
     } else if (cmd == "quit" || cmd == "exit") {
         result.output = "Exiting...";
@@ -544,6 +1131,35 @@ std::string ClaudeConsole::FormatExecutionTime(const std::chrono::microseconds&
     }
 }
 
+std::string ClaudeConsole::FormatExecutionTime(const CommandResult& result) {
+    std::string text = FormatExecutionTime(result.executionTime);
+    if (result.usage.measured) {
+        text += ", " + FormatResourceUsage(result.usage);
+    }
+    if (result.droppedBytes > 0) {
+        text += std::format(", {} of output dropped", FormatByteCount(result.droppedBytes));
+    }
+    for (size_t i = 0; i < result.stages.size(); ++i) {
+        const StageStats& stage = result.stages[i];
+        text += std::format("{} {} [{}, cpu {}, {}", i == 0 ? ":" : " |", stage.command,
+                            FormatExecutionTime(stage.wallTime), FormatExecutionTime(stage.cpuTime),
+                            FormatByteCount(stage.bytesOut));
+        if (stage.exitCode != 0) {
+            text += std::format(", exit {}", stage.exitCode);
+        }
+        text += "]";
+    }
+    return text;
+}
+
+std::string ClaudeConsole::FormatResourceUsage(const ResourceUsage& usage) {
+    return std::format("user {}, sys {}, rss {}, ctx {}/{}, io {}/{}",
+                       FormatExecutionTime(usage.userTime), FormatExecutionTime(usage.systemTime),
+                       FormatByteCount(static_cast<uint64_t>(usage.maxRssKb) * 1024),
+                       usage.voluntarySwitches, usage.involuntarySwitches,
+                       FormatByteCount(usage.bytesRead), FormatByteCount(usage.bytesWritten));
+}
+
 std::vector<std::string> ClaudeConsole::SplitCommand(const std::string& command) {
     std::vector<std::string> words;
     std::istringstream iss(command);
@@ -591,6 +1207,26 @@ void ClaudeConsole::CreateConfigDirectory() {
             config << "  \"show_execution_time\": true,\n";
             config << "  \"history_size\": 1000,\n";
             config << "  \"enable_colors\": true,\n";
+            config << "  \"command_timeout_seconds\": 0,\n";
+            config << "  \"javascript_timeout_seconds\": 0,\n";
+            config << "  \"output_spill_threshold_mb\": 64,\n";
+            config << "  \"output_retention\": \"all\",\n";
+            config << "  \"output_retention_kb\": 64,\n";
+            config << "  \"command_limits\": {\n";
+            config << "    \"nice\": 0,\n";
+            config << "    \"cpus\": \"\",\n";
+            config << "    \"memory_mb\": 0,\n";
+            config << "    \"cpu_seconds\": 0,\n";
+            config << "    \"cgroup\": \"\"\n";
+            config << "  },\n";
+            config << "  \"repl_cpus\": \"\",\n";
+            config << "  \"javascript_worker_cpus\": \"\",\n";
+            config << "  \"javascript_warm_up\": false,\n";
+            config << "  \"init_snapshot\": true,\n";
+            config << "  \"code_cache\": true,\n";
+            config << "  \"script_cache_size\": 256,\n";
+            config << "  \"streaming_threshold_mb\": 16,\n";
+            config << "  \"idle_task_ms\": 20,\n";
             config << "  \"claude_integration\": {\n";
             config << "    \"enabled\": true,\n";
             config << "    \"timeout_seconds\": 30\n";
@@ -627,8 +1263,92 @@ void ClaudeConsole::LoadConfiguration() {
     // Then load app-specific configuration
     std::string configFile = GetConfigPath() + "/config.json";
     if (fs::exists(configFile)) {
-        // TODO: Parse JSON configuration
-        // For now, just load basic aliases from aliases file
+#ifdef HAS_JSON
+        std::ifstream jsonFile(configFile);
+        nlohmann::json config = nlohmann::json::parse(jsonFile, nullptr, false);
+        if (config.is_object()) {
+            // A key of the wrong type keeps its default, with a warning,
+            // instead of throwing out of the constructor
+            auto read = [this](const nlohmann::json& object, const char* key, auto fallback) {
+                using T = decltype(fallback);
+                auto it = object.find(key);
+                if (it == object.end()) return fallback;
+                const char* expected = std::is_same_v<T, bool> ? "true or false" :
+                                       std::is_arithmetic_v<T> ? "a number" : "a string";
+                bool valid = std::is_same_v<T, bool> ? it->is_boolean() :
+                             std::is_arithmetic_v<T> ? it->is_number() : it->is_string();
+                if constexpr (std::is_unsigned_v<T> && !std::is_same_v<T, bool>) {
+                    if (valid && it->template get<double>() < 0) {
+                        expected = "a number of at least 0";
+                        valid = false;
+                    }
+                }
+                if (!valid) {
+                    Error(std::format("config.json: {} should be {}; using the default\n", key, expected));
+                    return fallback;
+                }
+                return it->template get<T>();
+            };
+            shellTimeout_ = std::chrono::seconds(read(config, "command_timeout_seconds", 0));
+            javaScriptTimeout_ = std::chrono::seconds(read(config, "javascript_timeout_seconds", 0));
+            outputSpillThreshold_ = read(config, "output_spill_threshold_mb", size_t{64}) << 20;
+            std::string retention = read(config, "output_retention", std::string("all"));
+            size_t retainBytes = read(config, "output_retention_kb", size_t{64}) << 10;
+            if (retention == "head") {
+                SetOutputRetention(OutputRetention::Head, retainBytes);
+            } else if (retention == "tail") {
+                SetOutputRetention(OutputRetention::Tail, retainBytes);
+            } else if (retention == "head_tail") {
+                SetOutputRetention(OutputRetention::HeadAndTail, retainBytes);
+            } else {
+                SetOutputRetention(OutputRetention::All, retainBytes);
+            }
+            ProcessLimits limits;
+            auto commandLimits = config.find("command_limits");
+            if (commandLimits != config.end() && commandLimits->is_object()) {
+                // Through ParseOption, for the same range checks as "limit";
+                // a rejected value leaves the limit unset
+                std::string error;
+                auto option = [&](const std::string& text) {
+                    ProcessLimits parsed = limits;
+                    if (parsed.ParseOption(text, error)) {
+                        limits = parsed;
+                    } else {
+                        Error(std::format("config.json: command_limits: {}\n", error));
+                    }
+                };
+                if (int nice = read(*commandLimits, "nice", 0)) option(std::format("nice={}", nice));
+                if (rlim_t mb = read(*commandLimits, "memory_mb", rlim_t{0})) option(std::format("mem={}M", mb));
+                if (rlim_t seconds = read(*commandLimits, "cpu_seconds", rlim_t{0})) {
+                    option(std::format("cputime={}", seconds));
+                }
+                std::string cpus = read(*commandLimits, "cpus", std::string());
+                if (!cpus.empty()) option("cpus=" + cpus);
+                std::string cgroup = read(*commandLimits, "cgroup", std::string());
+                if (!cgroup.empty()) option("cgroup=" + cgroup);
+            }
+            SetCommandLimits(limits);
+            SetJavaScriptWarmUp(read(config, "javascript_warm_up", false));
+            SetInitSnapshot(read(config, "init_snapshot", true));
+            SetCodeCache(read(config, "code_cache", true));
+            SetScriptCacheCapacity(read(config, "script_cache_size", DefaultScriptCacheCapacity));
+            SetStreamingThreshold(read(config, "streaming_threshold_mb", DefaultStreamingThreshold >> 20) << 20);
+            SetIdleTaskBudget(std::chrono::milliseconds(read(config, "idle_task_ms", DefaultIdleTaskBudget.count())));
+            cpu_set_t cpus;
+            if (ProcessLimits::ParseCpuList(read(config, "javascript_worker_cpus", std::string()), cpus)) {
+                SetJavaScriptWorkerCpus(cpus);
+            }
+            if (ProcessLimits::ParseCpuList(read(config, "repl_cpus", std::string()), cpus)) {
+                SetReplCpus(cpus);
+            }
+            auto claude = config.find("claude_integration");
+            if (claude != config.end() && claude->is_object()) {
+                askTimeout_ = std::chrono::seconds(read(*claude, "timeout_seconds", 30));
+            }
+        }
+#endif
+        
+        // Aliases are kept in a file of their own
         std::string aliasFile = GetConfigPath() + "/aliases";
         if (fs::exists(aliasFile)) {
             std::ifstream file(aliasFile);
@@ -661,8 +1381,31 @@ void ClaudeConsole::SaveConfiguration() {
                             (mode_ == ConsoleMode::Ask) ? "ask" : "shell";
     config["prompt_format"] = promptFormat_;
     config["claude_prompt"] = claudePrompt_;
+    config["command_timeout_seconds"] = std::chrono::duration_cast<std::chrono::seconds>(shellTimeout_).count();
+    config["javascript_timeout_seconds"] = std::chrono::duration_cast<std::chrono::seconds>(javaScriptTimeout_).count();
+    config["output_spill_threshold_mb"] = outputSpillThreshold_ >> 20;
+    config["output_retention"] = outputRetention_ == OutputRetention::Head ? "head" :
+                                 outputRetention_ == OutputRetention::Tail ? "tail" :
+                                 outputRetention_ == OutputRetention::HeadAndTail ? "head_tail" : "all";
+    config["output_retention_kb"] = outputRetainBytes_ >> 10;
+    config["command_limits"] = {
+        {"nice", commandLimits_.nice},
+        {"cpus", commandLimits_.cpus ? ProcessLimits::FormatCpuList(*commandLimits_.cpus) : ""},
+        {"memory_mb", commandLimits_.addressSpace >> 20},
+        {"cpu_seconds", commandLimits_.cpuSeconds},
+        {"cgroup", commandLimits_.cgroup}
+    };
+    config["repl_cpus"] = replCpus_ ? ProcessLimits::FormatCpuList(*replCpus_) : "";
+    config["javascript_warm_up"] = warmUpJavaScript_;
+    config["init_snapshot"] = initSnapshot_;
+    config["code_cache"] = codeCacheEnabled_;
+    config["script_cache_size"] = scriptCacheCapacity_;
+    config["streaming_threshold_mb"] = streamingThreshold_ >> 20;
+    config["idle_task_ms"] = idleTaskBudget_.count();
+    config["javascript_worker_cpus"] = javaScriptWorkerCpus_ ? ProcessLimits::FormatCpuList(*javaScriptWorkerCpus_) : "";
     config["claude_integration"] = {
         {"enabled", true},
+        {"timeout_seconds", std::chrono::duration_cast<std::chrono::seconds>(askTimeout_).count()},
         {"api_key", ""}  // API key would be set via environment variable
     };
     
@@ -696,6 +1439,46 @@ std::string ClaudeConsole::GetConfigPath() const {
     return "./.config/cll"; // Fallback to current directory
 }
 
+std::string ClaudeConsole::StartupSnapshotPath() {
+    // CLL_STARTUP_SNAPSHOT points elsewhere, for the benchmark among others
+    if (const char* path = std::getenv("CLL_STARTUP_SNAPSHOT")) {
+        return path;
+    }
+    // Next to the executable, where the build puts it
+    std::error_code ec;
+    fs::path exe = fs::read_symlink("/proc/self/exe", ec);
+    return ((ec ? fs::path(".") : exe.parent_path()) / StartupSnapshotName).string();
+}
+
+std::string ClaudeConsole::InitScriptPath() const {
+    return GetConfigPath() + "/init.js";
+}
+
+void ClaudeConsole::SetScriptCacheCapacity(size_t capacity) {
+    scriptCacheCapacity_ = capacity;
+#ifdef HAS_V8
+    scriptCache_.SetCapacity(capacity);
+#endif
+}
+
+LruStats ClaudeConsole::GetScriptCacheStats() const {
+#ifdef HAS_V8
+    return scriptCache_.GetStats();
+#else
+    LruStats stats;
+    stats.capacity = scriptCacheCapacity_;
+    return stats;
+#endif
+}
+
+std::string ClaudeConsole::CodeCachePath() const {
+    return GetConfigPath() + "/cache/code";
+}
+
+std::string ClaudeConsole::InitSnapshotPath() const {
+    return GetConfigPath() + "/cache/init.snapshot";
+}
+
 std::string ClaudeConsole::GetSharedConfigPath() const {
     const char* home = std::getenv("HOME");
     if (!home) {
@@ -837,19 +1620,290 @@ std::string ClaudeConsole::GetClaudePrompt() const {
 }
 
 #ifdef HAS_V8
+// ICU, the startup data and the platform; process-wide, so any thread may do it
+std::unique_ptr<v8::Platform> ClaudeConsole::StartV8Platform() {
+    v8::V8::InitializeICUDefaultLocation("");
+    v8::V8::InitializeExternalStartupData("");
+    std::unique_ptr<v8::Platform> platform = v8_compat::CreateDefaultPlatform();
+    v8::V8::InitializePlatform(platform.get());
+    v8::V8::Initialize();
+    return platform;
+}
+
+// A snapshot file is a SourceManifest, headed by a key naming the kind of
+// snapshot and the V8 version, followed by the blob. V8 aborts on a blob
+// from another version, so the key is checked before it sees one.
+namespace {
+std::string SnapshotKey(std::string_view kind) {
+    return std::format("cll-{} {}", kind, v8::V8::GetVersion());
+}
+
+// Left beside a snapshot whose build failed: the manifest of the files the
+// attempt read, so it is not tried again until one of them changes
+std::string FailedSnapshotPath(const std::string& path) {
+    return path + ".failed";
+}
+
+bool SnapshotFailed(const std::string& path, const std::string& key) {
+    std::ifstream file(FailedSnapshotPath(path));
+    SourceManifest sources;
+    return file && sources.Read(file, key) && sources.IsCurrent();
+}
+
+// The blob taken from a creator whose default context is set, or empty
+std::string CreateBlob(v8::SnapshotCreator& creator, v8::SnapshotCreator::FunctionCodeHandling code) {
+    v8::StartupData blob = creator.CreateBlob(code);
+    std::string data;
+    if (blob.data) {
+        data.assign(blob.data, static_cast<size_t>(blob.raw_size));
+        delete[] blob.data;
+    }
+    return data;
+}
+
+// Written aside and renamed, so a running console never reads half a file
+bool WriteSnapshotFile(const std::string& path, const std::string& key, const SourceManifest& sources,
+                       const std::string& blob, std::string& error) {
+    std::string temp = path + ".tmp";
+    {
+        std::ofstream out(temp, std::ios::binary | std::ios::trunc);
+        sources.Write(out, key);
+        out.write(blob.data(), static_cast<std::streamsize>(blob.size()));
+        if (!out) {
+            error = std::format("Cannot write {}", temp);
+            return false;
+        }
+    }
+    std::error_code ec;
+    fs::rename(temp, path, ec);
+    if (ec) {
+        error = std::format("Cannot write {}: {}", path, ec.message());
+        return false;
+    }
+    fs::remove(FailedSnapshotPath(path), ec);
+    return true;
+}
+} // namespace
+
+bool ClaudeConsole::ReadSnapshot(const std::string& path, const std::string& key) {
+    std::ifstream file(path, std::ios::binary);
+    SourceManifest sources;
+    if (!file || !sources.Read(file, key) || !sources.IsCurrent()) {
+        return false;
+    }
+    snapshotData_.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+    snapshotBlob_ = {snapshotData_.data(), static_cast<int>(snapshotData_.size())};
+    return !snapshotData_.empty() && snapshotBlob_.IsValid();
+}
+
+bool ClaudeConsole::LoadStartupSnapshot() {
+    return ReadSnapshot(StartupSnapshotPath(), SnapshotKey("snapshot"));
+}
+
+bool ClaudeConsole::LoadInitSnapshot() {
+    if (!fs::exists(InitScriptPath())) {
+        return false;
+    }
+    std::string path = InitSnapshotPath();
+    std::string key = SnapshotKey("init-snapshot");
+    if (ReadSnapshot(path, key)) {
+        return true;
+    }
+    if (SnapshotFailed(path, key)) {
+        return false;
+    }
+    
+    // Missing or stale: build it now, so this start pays once for the next
+    std::string error;
+    if (!WriteInitSnapshot(path, error)) {
+        Error(std::format("init.js snapshot: {}\n", error));
+        return false;
+    }
+    return ReadSnapshot(path, key);
+}
+
+bool ClaudeConsole::WriteStartupSnapshot(const std::string& path, std::string& error) {
+    std::unique_ptr<v8::Platform> platform = StartV8Platform();
+    std::string blob;
+    {
+        std::unique_ptr<v8::SnapshotCreator> creator = v8_compat::CreateSnapshotCreator(ExternalReferences());
+        v8::Isolate* isolate = creator->GetIsolate();
+        {
+            v8::HandleScope handle_scope(isolate);
+            v8::Local<v8::Context> context = v8::Context::New(isolate);
+            v8::Context::Scope context_scope(context);
+            RegisterBuiltins(isolate, context);
+            creator->SetDefaultContext(context);
+        }
+        blob = CreateBlob(*creator, v8::SnapshotCreator::FunctionCodeHandling::kClear);
+    }
+    v8::V8::Dispose();
+    if (blob.empty()) {
+        error = "V8 could not create the snapshot";
+        return false;
+    }
+    return WriteSnapshotFile(path, SnapshotKey("snapshot"), SourceManifest(), blob, error);
+}
+
+bool ClaudeConsole::WriteInitSnapshot(const std::string& path, std::string& error) {
+    if (isolate_) {
+        error = "JavaScript is already running";
+        return false;
+    }
+    if (!platform_) {
+        platform_ = StartV8Platform();
+    }
+    instance_ = this;
+    std::error_code ec;
+    fs::create_directories(fs::path(path).parent_path(), ec);
+    std::string key = SnapshotKey("init-snapshot");
+    std::string initScript = InitScriptPath();
+    
+    SourceManifest sources;
+    std::string blob;
+    {
+        std::unique_ptr<v8::SnapshotCreator> creator = v8_compat::CreateSnapshotCreator(ExternalReferences());
+        v8::Isolate* isolate = creator->GetIsolate();
+        bool ran = true;
+        {
+            v8::HandleScope handle_scope(isolate);
+            v8::Local<v8::Context> context = v8::Context::New(isolate);
+            v8::Context::Scope context_scope(context);
+            RegisterBuiltins(isolate, context);
+            
+            // ExecuteFile and load() run in the creator's isolate for now,
+            // and record what they read
+            isolate_ = isolate;
+            context_.Reset(isolate, context);
+            snapshotSources_ = &sources;
+            snapshotUnsupported_ = false;
+            ran = ExecuteFile(initScript) && !snapshotUnsupported_;
+            snapshotSources_ = nullptr;
+            context_.Reset();
+            isolate_ = nullptr;
+            creator->SetDefaultContext(context);
+        }
+        if (!ran) {
+            // The creator must still make its blob before it can go away
+            CreateBlob(*creator, v8::SnapshotCreator::FunctionCodeHandling::kClear);
+            error = snapshotUnsupported_ ? "init.js loads a DLL, which a snapshot cannot hold"
+                                         : "init.js failed";
+            sources.Add(initScript);
+            std::ofstream marker(FailedSnapshotPath(path), std::ios::trunc);
+            sources.Write(marker, key);
+            return false;
+        }
+        // Keeping compiled code is what saves later sessions the parse
+        blob = CreateBlob(*creator, v8::SnapshotCreator::FunctionCodeHandling::kKeep);
+    }
+    if (blob.empty()) {
+        error = "V8 could not create the snapshot";
+        return false;
+    }
+    return WriteSnapshotFile(path, key, sources, blob, error);
+}
+
+// External strings over a ScriptSource's buffers. Each keeps the source
+// alive for as long as V8 holds the string, which is as long as the
+// script lives: V8 reads the text again to compile functions lazily.
+namespace {
+class ExternalLatin1Source : public v8::String::ExternalOneByteStringResource {
+public:
+    explicit ExternalLatin1Source(std::shared_ptr<const ScriptSource> source) : source_(std::move(source)) {}
+    const char* data() const override { return source_->Latin1().data(); }
+    size_t length() const override { return source_->Latin1().size(); }
+
+private:
+    std::shared_ptr<const ScriptSource> source_;
+};
+
+class ExternalUtf16Source : public v8::String::ExternalStringResource {
+public:
+    explicit ExternalUtf16Source(std::shared_ptr<const ScriptSource> source) : source_(std::move(source)) {}
+    const uint16_t* data() const override { return reinterpret_cast<const uint16_t*>(source_->Utf16().data()); }
+    size_t length() const override { return source_->Utf16().size(); }
+
+private:
+    std::shared_ptr<const ScriptSource> source_;
+};
+
+// V8 owns the resource once the string exists, and frees it with the string
+template <typename Resource, typename Make>
+v8::MaybeLocal<v8::String> NewExternal(const std::shared_ptr<const ScriptSource>& source, Make make) {
+    auto resource = std::make_unique<Resource>(source);
+    v8::MaybeLocal<v8::String> string = make(resource.get());
+    if (!string.IsEmpty()) {
+        resource.release();
+    }
+    return string;
+}
+
+v8::MaybeLocal<v8::String> NewSourceString(v8::Isolate* isolate, const std::shared_ptr<const ScriptSource>& source) {
+    switch (source->GetEncoding()) {
+        case ScriptSource::Encoding::Latin1:
+            return NewExternal<ExternalLatin1Source>(source, [isolate](auto* resource) {
+                return v8::String::NewExternalOneByte(isolate, resource);
+            });
+        case ScriptSource::Encoding::Utf16:
+            return NewExternal<ExternalUtf16Source>(source, [isolate](auto* resource) {
+                return v8::String::NewExternalTwoByte(isolate, resource);
+            });
+        default:
+            // Not UTF-8: V8 decodes it, replacing what it cannot
+            return v8::String::NewFromUtf8(isolate, source->Bytes().data(), v8::NewStringType::kNormal,
+                                           static_cast<int>(source->Bytes().size()));
+    }
+}
+} // namespace
+
 // V8 JavaScript execution methods
 bool ClaudeConsole::ExecuteFile(const std::string& path) {
-    std::string source = ReadFile(path);
-    if (source.empty()) {
+    std::error_code ec;
+    uintmax_t size = fs::file_size(path, ec);
+    if (!ec && streamingThreshold_ > 0 && size >= streamingThreshold_ && !snapshotSources_) {
+        if (!EnsureJavaScript()) return false;
+        WatchdogScope watchdog(scriptWatched_, isolate_, javaScriptTimeout_, cancel_,
+                               [this](const std::string& reason) { Error(reason); });
+        RunFinishedLoads(true);
+        
+        v8::Isolate::Scope isolate_scope(isolate_);
+        v8::HandleScope handle_scope(isolate_);
+        StreamedScript streamed(isolate_, path);
+        std::string error;
+        if (!streamed.Start(error)) {
+            Error(error + "\n");
+            return false;
+        }
+        return RunStreamed(streamed);
+    }
+    
+    std::string error;
+    std::shared_ptr<const ScriptSource> source = ScriptSource::Open(path, error);
+    if (!source || source->Bytes().empty()) {
         Error(std::format("Error: Could not read file: \"{}\"\n", path));
         return false;
     }
+    if (snapshotSources_) {
+        snapshotSources_->Add(path);
+    }
+    if (!EnsureJavaScript()) return false;
+    WatchdogScope watchdog(scriptWatched_, isolate_, javaScriptTimeout_, cancel_,
+                           [this](const std::string& reason) { Error(reason); });
+    RunFinishedLoads(true);
     
-    return ExecuteString(source, path);
+    v8::Isolate::Scope isolate_scope(isolate_);
+    v8::HandleScope handle_scope(isolate_);
+    v8::Local<v8::Context> context = context_.Get(isolate_);
+    v8::Context::Scope context_scope(context);
+    
+    return CompileAndRun(source->Bytes(), path, codeCacheEnabled_, source);
 }
 
 bool ClaudeConsole::ExecuteString(const std::string& source, const std::string& name) {
-    if (!isolate_) return false;
+    if (!EnsureJavaScript()) return false;
+    WatchdogScope watchdog(scriptWatched_, isolate_, javaScriptTimeout_, cancel_,
+                           [this](const std::string& reason) { Error(reason); });
+    RunFinishedLoads(true);
     
     v8::Isolate::Scope isolate_scope(isolate_);
     v8::HandleScope handle_scope(isolate_);
@@ -859,27 +1913,182 @@ bool ClaudeConsole::ExecuteString(const std::string& source, const std::string&
     return CompileAndRun(source, name);
 }
 
-bool ClaudeConsole::CompileAndRun(const std::string& source, const std::string& name) {
+bool ClaudeConsole::CompileAndRun(std::string_view source, const std::string& name, bool useCodeCache,
+                                  const std::shared_ptr<const ScriptSource>& file) {
     v8::HandleScope handle_scope(isolate_);
     v8::Local<v8::Context> context = context_.Get(isolate_);
     v8::Context::Scope context_scope(context);
     
     v8::TryCatch tryCatch(isolate_);
     
-    // Compile the script
-    v8::Local<v8::String> sourceV8 = v8::String::NewFromUtf8(isolate_, source.c_str()).ToLocalChecked();
+    // A snippet seen before skips compilation. Not while a snapshot is
+    // built: its isolate goes away with the creator. Long sources are
+    // keyed by length and hash, so the cache holds no copy of them.
+    bool useScriptCache = !snapshotSources_ && scriptCache_.Capacity() > 0;
+    std::string cacheKey;
+    if (useScriptCache) {
+        cacheKey = source.size() > ScriptCacheInlineKeyBytes
+            ? std::format("{}{}{}:{:016x}", name, '\0', source.size(), SourceManifest::Hash(source))
+            : std::format("{}{}{}", name, '\0', source);
+        if (auto* unbound = scriptCache_.Find(cacheKey)) {
+            return RunScript(unbound->Get(isolate_)->BindToCurrentContext(), name, tryCatch);
+        }
+    }
+    
+    // Compile the script; a file's text becomes an external string over
+    // its buffer rather than a copy in V8's heap
+    v8::Local<v8::String> sourceV8;
+    if (!(file ? NewSourceString(isolate_, file)
+               : v8::String::NewFromUtf8(isolate_, source.data(), v8::NewStringType::kNormal,
+                                         static_cast<int>(source.size()))).ToLocal(&sourceV8)) {
+        Error(std::format("Error: {} is too large for a JavaScript string\n", name));
+        return false;
+    }
     v8::Local<v8::String> nameV8 = v8::String::NewFromUtf8(isolate_, name.c_str()).ToLocalChecked();
     
     v8::ScriptOrigin origin = v8_compat::CreateScriptOrigin(isolate_, nameV8);
+    if (useCodeCache && !codeCache_) {
+        codeCache_ = std::make_unique<CodeCache>(CodeCachePath(), v8::V8::GetVersion());
+    }
+    
+    // Cached data is only borrowed; the Source owns the CachedData wrapper
+    std::optional<std::string> cachedData = useCodeCache ? codeCache_->Find(source) : std::nullopt;
+    v8::ScriptCompiler::CachedData* cached = nullptr;
+    if (cachedData) {
+        cached = new v8::ScriptCompiler::CachedData(reinterpret_cast<const uint8_t*>(cachedData->data()),
+            static_cast<int>(cachedData->size()), v8::ScriptCompiler::CachedData::BufferNotOwned);
+    }
+    v8::ScriptCompiler::Source scriptSource(sourceV8, origin, cached);
     v8::Local<v8::Script> script;
-    if (!v8::Script::Compile(context, sourceV8, &origin).ToLocal(&script)) {
+    if (!v8::ScriptCompiler::Compile(context, &scriptSource,
+            cached ? v8::ScriptCompiler::kConsumeCodeCache : v8::ScriptCompiler::kNoCompileOptions)
+            .ToLocal(&script)) {
         ReportException(&tryCatch);
         return false;
     }
     
-    // Run the script
+    bool needsCodeCache = useCodeCache;
+    if (cached) {
+        if (scriptSource.GetCachedData()->rejected) {
+            codeCache_->Reject(source);
+        } else {
+            codeCache_->Accept();
+            needsCodeCache = false;
+        }
+    }
+    
+    if (useScriptCache) {
+        scriptCache_.Insert(std::move(cacheKey), v8::Global<v8::UnboundScript>(isolate_, script->GetUnboundScript()));
+    }
+    
+    if (!RunScript(script, name, tryCatch)) {
+        return false;
+    }
+    
+    // Made after running, so it covers the functions the run compiled too
+    if (needsCodeCache) {
+        std::unique_ptr<v8::ScriptCompiler::CachedData> created(
+            v8::ScriptCompiler::CreateCodeCache(script->GetUnboundScript()));
+        if (created && created->length > 0) {
+            codeCache_->Store(source, std::string_view(reinterpret_cast<const char*>(created->data),
+                                                       static_cast<size_t>(created->length)));
+        }
+    }
+    return true;
+}
+
+bool ClaudeConsole::LoadFileInBackground(const std::string& path) {
+    if (!EnsureJavaScript()) return false;
+    
+    v8::Isolate::Scope isolate_scope(isolate_);
+    v8::HandleScope handle_scope(isolate_);
+    auto streamed = std::make_unique<StreamedScript>(isolate_, path);
+    std::string error;
+    if (!streamed->Start(error)) {
+        Error(error + "\n");
+        return false;
+    }
+    backgroundLoads_.push_back(std::move(streamed));
+    return true;
+}
+
+// Loads run in the order they were started, so one may rely on another
+size_t ClaudeConsole::RunFinishedLoads(bool wait) {
+    size_t ran = 0;
+    if (backgroundLoads_.empty()) return ran;
+    WatchdogScope watchdog(scriptWatched_, isolate_, javaScriptTimeout_, cancel_,
+                           [this](const std::string& reason) { Error(reason); });
+    while (!backgroundLoads_.empty() && (wait || backgroundLoads_.front()->Done()) && !cancel_.IsCancelled()) {
+        // Off the queue first: the script may itself load or run JavaScript
+        std::unique_ptr<StreamedScript> streamed = std::move(backgroundLoads_.front());
+        backgroundLoads_.pop_front();
+        
+        v8::Isolate::Scope isolate_scope(isolate_);
+        v8::HandleScope handle_scope(isolate_);
+        RunStreamed(*streamed);
+        ++ran;
+    }
+    return ran;
+}
+
+size_t ClaudeConsole::PendingLoads() const {
+    return backgroundLoads_.size();
+}
+
+size_t ClaudeConsole::PumpMessageLoop() {
+    if (!isolate_) return 0;
+    // Tasks and microtasks run user callbacks, such as promise reactions
+    WatchdogScope watchdog(scriptWatched_, isolate_, javaScriptTimeout_, cancel_,
+                           [this](const std::string& reason) { Error(reason); });
+    v8::Isolate::Scope isolate_scope(isolate_);
+    v8::HandleScope handle_scope(isolate_);
+    // A task may post another; run until the queue is empty, as d8 does
+    size_t ran = 0;
+    while (!cancel_.IsCancelled() && v8::platform::PumpMessageLoop(platform_.get(), isolate_)) {
+        isolate_->PerformMicrotaskCheckpoint();
+        ++ran;
+    }
+    return ran;
+}
+
+void ClaudeConsole::RunIdleTasks() {
+    if (!isolate_ || idleTaskBudget_.count() <= 0) return;
+    v8::Isolate::Scope isolate_scope(isolate_);
+    v8::HandleScope handle_scope(isolate_);
+    v8::platform::RunIdleTasks(platform_.get(), isolate_,
+                               std::chrono::duration<double>(idleTaskBudget_).count());
+}
+
+bool ClaudeConsole::RunStreamed(StreamedScript& streamed) {
+    v8::Local<v8::Context> context = context_.Get(isolate_);
+    v8::Context::Scope context_scope(context);
+    v8::TryCatch tryCatch(isolate_);
+    
+    // The text read for the parse becomes an external string, as in CompileAndRun
+    v8::Local<v8::String> text;
+    if (!NewSourceString(isolate_, streamed.Text()).ToLocal(&text)) {
+        Error(std::format("Error: {} is too large for a JavaScript string\n", streamed.Path()));
+        return false;
+    }
+    v8::Local<v8::Script> script;
+    if (!streamed.Finish(context, text).ToLocal(&script)) {
+        if (tryCatch.HasCaught()) {
+            ReportException(&tryCatch);
+        } else {
+            Error(std::format("Error: Could not compile \"{}\"\n", streamed.Path()));
+        }
+        return false;
+    }
+    return RunScript(script, streamed.Path(), tryCatch);
+}
+
+bool ClaudeConsole::RunScript(v8::Local<v8::Script> script, const std::string& name, v8::TryCatch& tryCatch) {
     v8::Local<v8::Value> result;
-    if (!script->Run(context).ToLocal(&result)) {
+    if (!script->Run(isolate_->GetCurrentContext()).ToLocal(&result)) {
+        if (tryCatch.HasTerminated()) {
+            // Stopped by the watchdog; ExecuteJavaScript reports why
+            return false;
+        }
         ReportException(&tryCatch);
         return false;
     }
@@ -892,15 +2101,6 @@ bool ClaudeConsole::CompileAndRun(const std::string& source, const std::string&
     return true;
 }
 
-std::string ClaudeConsole::ReadFile(const std::string& path) {
-    std::ifstream file(path, std::ios::binary);
-    if (file) {
-        return std::string(std::istreambuf_iterator<char>(file), 
-                          std::istreambuf_iterator<char>());
-    }
-    return "";
-}
-
 void ClaudeConsole::ReportException(v8::TryCatch* tryCatch) {
     v8::HandleScope handle_scope(isolate_);
     v8::String::Utf8Value exception(isolate_, tryCatch->Exception());
@@ -957,7 +2157,13 @@ void ClaudeConsole::PrintResult(v8::Local<v8::Value> value) {
 
 // DLL loading methods
 bool ClaudeConsole::LoadDll(const std::string& path) {
-    if (!dllLoader_ || !isolate_) return false;
+    if (snapshotSources_) {
+        // Native functions are not in ExternalReferences(), so a snapshot
+        // holding them could not be written
+        snapshotUnsupported_ = true;
+        return false;
+    }
+    if (!EnsureJavaScript() || !dllLoader_) return false;
     
     v8::Isolate::Scope isolate_scope(isolate_);
     v8::HandleScope handle_scope(isolate_);
@@ -985,7 +2191,7 @@ bool ClaudeConsole::UnloadDll(const std::string& path) {
 }
 
 bool ClaudeConsole::ReloadDll(const std::string& path) {
-    if (!dllLoader_ || !isolate_) return false;
+    if (!EnsureJavaScript() || !dllLoader_) return false;
     
     v8::Isolate::Scope isolate_scope(isolate_);
     v8::HandleScope handle_scope(isolate_);
@@ -1001,47 +2207,76 @@ std::vector<std::string> ClaudeConsole::GetLoadedDlls() const {
 }
 
 // V8 built-in functions
-void ClaudeConsole::RegisterBuiltins(v8::Local<v8::Context> context) {
-    v8::HandleScope handle_scope(isolate_);
+// Every native callback behind a builtin, null-terminated. A snapshot
+// stores these as indexes into this list, so the snapshot tool and the
+// console must see the same one: add new builtins here too.
+const intptr_t* ClaudeConsole::ExternalReferences() {
+    static const intptr_t references[] = {
+        reinterpret_cast<intptr_t>(&Print),
+        reinterpret_cast<intptr_t>(&Load),
+        reinterpret_cast<intptr_t>(&LoadDllFunc),
+        reinterpret_cast<intptr_t>(&UnloadDllFunc),
+        reinterpret_cast<intptr_t>(&ReloadDllFunc),
+        reinterpret_cast<intptr_t>(&ListDllsFunc),
+        reinterpret_cast<intptr_t>(&ShFunc),
+        reinterpret_cast<intptr_t>(&LastUsageFunc),
+        reinterpret_cast<intptr_t>(&QuitFunc),
+        reinterpret_cast<intptr_t>(&HelpFunc),
+        0
+    };
+    return references;
+}
+
+void ClaudeConsole::RegisterBuiltins(v8::Isolate* isolate, v8::Local<v8::Context> context) {
+    v8::HandleScope handle_scope(isolate);
     
     // Get the global object
     v8::Local<v8::Object> global = context->Global();
     
     // Register print function
     global->Set(context,
-        v8::String::NewFromUtf8(isolate_, "print").ToLocalChecked(),
-        v8::FunctionTemplate::New(isolate_, Print)->GetFunction(context).ToLocalChecked());
+        v8::String::NewFromUtf8(isolate, "print").ToLocalChecked(),
+        v8::FunctionTemplate::New(isolate, Print)->GetFunction(context).ToLocalChecked());
     
     // Register load function
     global->Set(context,
-        v8::String::NewFromUtf8(isolate_, "load").ToLocalChecked(),
-        v8::FunctionTemplate::New(isolate_, Load)->GetFunction(context).ToLocalChecked());
+        v8::String::NewFromUtf8(isolate, "load").ToLocalChecked(),
+        v8::FunctionTemplate::New(isolate, Load)->GetFunction(context).ToLocalChecked());
     
     // Register DLL functions
     global->Set(context,
-        v8::String::NewFromUtf8(isolate_, "loadDll").ToLocalChecked(),
-        v8::FunctionTemplate::New(isolate_, LoadDllFunc)->GetFunction(context).ToLocalChecked());
+        v8::String::NewFromUtf8(isolate, "loadDll").ToLocalChecked(),
+        v8::FunctionTemplate::New(isolate, LoadDllFunc)->GetFunction(context).ToLocalChecked());
+        
+    global->Set(context,
+        v8::String::NewFromUtf8(isolate, "unloadDll").ToLocalChecked(),
+        v8::FunctionTemplate::New(isolate, UnloadDllFunc)->GetFunction(context).ToLocalChecked());
         
     global->Set(context,
-        v8::String::NewFromUtf8(isolate_, "unloadDll").ToLocalChecked(),
-        v8::FunctionTemplate::New(isolate_, UnloadDllFunc)->GetFunction(context).ToLocalChecked());
+        v8::String::NewFromUtf8(isolate, "reloadDll").ToLocalChecked(),
+        v8::FunctionTemplate::New(isolate, ReloadDllFunc)->GetFunction(context).ToLocalChecked());
         
     global->Set(context,
-        v8::String::NewFromUtf8(isolate_, "reloadDll").ToLocalChecked(),
-        v8::FunctionTemplate::New(isolate_, ReloadDllFunc)->GetFunction(context).ToLocalChecked());
+        v8::String::NewFromUtf8(isolate, "listDlls").ToLocalChecked(),
+        v8::FunctionTemplate::New(isolate, ListDllsFunc)->GetFunction(context).ToLocalChecked());
         
+    // Register shell function
+    global->Set(context,
+        v8::String::NewFromUtf8(isolate, "sh").ToLocalChecked(),
+        v8::FunctionTemplate::New(isolate, ShFunc)->GetFunction(context).ToLocalChecked());
+    
     global->Set(context,
-        v8::String::NewFromUtf8(isolate_, "listDlls").ToLocalChecked(),
-        v8::FunctionTemplate::New(isolate_, ListDllsFunc)->GetFunction(context).ToLocalChecked());
+        v8::String::NewFromUtf8(isolate, "lastUsage").ToLocalChecked(),
+        v8::FunctionTemplate::New(isolate, LastUsageFunc)->GetFunction(context).ToLocalChecked());
         
     // Register utility functions
     global->Set(context,
-        v8::String::NewFromUtf8(isolate_, "quit").ToLocalChecked(),
-        v8::FunctionTemplate::New(isolate_, QuitFunc)->GetFunction(context).ToLocalChecked());
+        v8::String::NewFromUtf8(isolate, "quit").ToLocalChecked(),
+        v8::FunctionTemplate::New(isolate, QuitFunc)->GetFunction(context).ToLocalChecked());
         
     global->Set(context,
-        v8::String::NewFromUtf8(isolate_, "help").ToLocalChecked(),
-        v8::FunctionTemplate::New(isolate_, HelpFunc)->GetFunction(context).ToLocalChecked());
+        v8::String::NewFromUtf8(isolate, "help").ToLocalChecked(),
+        v8::FunctionTemplate::New(isolate, HelpFunc)->GetFunction(context).ToLocalChecked());
 }
 
 void ClaudeConsole::Print(const v8::FunctionCallbackInfo<v8::Value>& args) {
@@ -1065,11 +2300,22 @@ void ClaudeConsole::Print(const v8::FunctionCallbackInfo<v8::Value>& args) {
 void ClaudeConsole::Load(const v8::FunctionCallbackInfo<v8::Value>& args) {
     if (!instance_ || args.Length() < 1) return;
     
-    v8::HandleScope handle_scope(args.GetIsolate());
-    v8::String::Utf8Value file(args.GetIsolate(), args[0]);
+    v8::Isolate* isolate = args.GetIsolate();
+    v8::HandleScope handle_scope(isolate);
+    v8::String::Utf8Value file(isolate, args[0]);
     const char* filename = *file ? *file : "";
     
-    bool success = instance_->ExecuteFile(filename);
+    // load(path, {background: true}) returns once the file is streaming
+    bool background = false;
+    if (args.Length() > 1 && args[1]->IsObject() && !instance_->snapshotSources_) {
+        v8::Local<v8::Value> value;
+        if (args[1].As<v8::Object>()->Get(isolate->GetCurrentContext(),
+                v8::String::NewFromUtf8(isolate, "background").ToLocalChecked()).ToLocal(&value)) {
+            background = value->BooleanValue(isolate);
+        }
+    }
+    
+    bool success = background ? instance_->LoadFileInBackground(filename) : instance_->ExecuteFile(filename);
     args.GetReturnValue().Set(v8::Boolean::New(args.GetIsolate(), success));
 }
 
@@ -1124,6 +2370,105 @@ void ClaudeConsole::ListDllsFunc(const v8::FunctionCallbackInfo<v8::Value>& args
     args.GetReturnValue().Set(result);
 }
 
+void ClaudeConsole::ShFunc(const v8::FunctionCallbackInfo<v8::Value>& args) {
+    if (!instance_ || args.Length() < 1) return;
+    
+    v8::Isolate* isolate = args.GetIsolate();
+    v8::HandleScope handle_scope(isolate);
+    v8::Local<v8::Context> context = isolate->GetCurrentContext();
+    v8::String::Utf8Value command(isolate, args[0]);
+    
+    // sh(command, {stdin: data}): buffers and sh() output are fed in place;
+    // other strings are converted to UTF-8 once
+    std::optional<std::string_view> input;
+    std::shared_ptr<v8::BackingStore> buffer;
+    std::optional<v8::String::Utf8Value> text;
+    std::optional<ProcessLimits> limits;
+    if (args.Length() > 1 && args[1]->IsObject()) {
+        v8::Local<v8::Object> options = args[1].As<v8::Object>();
+        
+        // {nice, cpus, mem, cputime, cgroup} take the values "limit" does
+        for (const char* key : {"nice", "cpus", "mem", "cputime", "cgroup"}) {
+            v8::Local<v8::Value> value;
+            if (!options->Get(context, v8::String::NewFromUtf8(isolate, key).ToLocalChecked()).ToLocal(&value)) {
+                return;
+            }
+            if (value->IsUndefined()) continue;
+            v8::String::Utf8Value valueText(isolate, value);
+            std::string error;
+            if (!limits) limits.emplace();
+            if (!limits->ParseOption(std::format("{}={}", key, *valueText ? *valueText : ""), error)) {
+                isolate->ThrowException(v8::Exception::TypeError(
+                    v8::String::NewFromUtf8(isolate, ("sh: " + error).c_str()).ToLocalChecked()));
+                return;
+            }
+        }
+        
+        v8::Local<v8::Value> data;
+        if (!options->Get(context,
+                v8::String::NewFromUtf8(isolate, "stdin").ToLocalChecked()).ToLocal(&data)) {
+            return;
+        }
+        if (data->IsArrayBuffer()) {
+            buffer = data.As<v8::ArrayBuffer>()->GetBackingStore();
+            input = std::string_view(static_cast<const char*>(buffer->Data()), buffer->ByteLength());
+        } else if (data->IsArrayBufferView()) {
+            auto view = data.As<v8::ArrayBufferView>();
+            buffer = view->Buffer()->GetBackingStore();
+            input = std::string_view(static_cast<const char*>(buffer->Data()) + view->ByteOffset(),
+                                     view->ByteLength());
+        } else if (data->IsString() && data.As<v8::String>()->IsExternalOneByte()) {
+            auto resource = data.As<v8::String>()->GetExternalOneByteStringResource();
+            input = std::string_view(resource->data(), resource->length());
+        } else if (!data->IsUndefined()) {
+            text.emplace(isolate, data);
+            input = std::string_view(**text ? **text : "", **text ? text->length() : 0);
+        }
+    }
+    
+    CommandResult result = instance_->CaptureShellCommand(*command ? *command : "", input,
+                                                          limits ? &*limits : nullptr);
+    if (!result.error.empty()) {
+        instance_->Error(result.error + "\n");
+    }
+    
+    v8::Local<v8::String> output;
+    if (!NewOutputString(isolate, result).ToLocal(&output)) {
+        isolate->ThrowException(v8::Exception::RangeError(
+            v8::String::NewFromUtf8(isolate, "sh: output too large for a string").ToLocalChecked()));
+        return;
+    }
+    args.GetReturnValue().Set(output);
+}
+
+void ClaudeConsole::LastUsageFunc(const v8::FunctionCallbackInfo<v8::Value>& args) {
+    if (!instance_) return;
+    
+    v8::Isolate* isolate = args.GetIsolate();
+    v8::HandleScope handle_scope(isolate);
+    v8::Local<v8::Context> context = isolate->GetCurrentContext();
+    
+    const ResourceUsage& usage = instance_->GetLastUsage();
+    if (!usage.measured) {
+        args.GetReturnValue().SetNull();
+        return;
+    }
+    
+    v8::Local<v8::Object> result = v8::Object::New(isolate);
+    auto set = [&](const char* name, double value) {
+        result->Set(context, v8::String::NewFromUtf8(isolate, name).ToLocalChecked(),
+                    v8::Number::New(isolate, value)).Check();
+    };
+    set("userMs", usage.userTime.count() / 1000.0);
+    set("systemMs", usage.systemTime.count() / 1000.0);
+    set("maxRssKb", static_cast<double>(usage.maxRssKb));
+    set("voluntarySwitches", static_cast<double>(usage.voluntarySwitches));
+    set("involuntarySwitches", static_cast<double>(usage.involuntarySwitches));
+    set("bytesRead", static_cast<double>(usage.bytesRead));
+    set("bytesWritten", static_cast<double>(usage.bytesWritten));
+    args.GetReturnValue().Set(result);
+}
+
 void ClaudeConsole::QuitFunc(const v8::FunctionCallbackInfo<v8::Value>& args) {
     if (!instance_) return;
     instance_->Output("Goodbye!\n");
@@ -1140,12 +2485,25 @@ void ClaudeConsole::HelpFunc(const v8::FunctionCallbackInfo<v8::Value>& args) {
     instance_->Output("  unloadDll(path) - Unload a DLL\n");
     instance_->Output("  reloadDll(path) - Reload a DLL\n");
     instance_->Output("  listDlls() - List loaded DLLs\n");
+    instance_->Output("  sh(command[, {stdin}]) - Run a shell command, feeding it stdin, and return its output\n");
+    instance_->Output("  sh(command, {nice, cpus, mem, cputime, cgroup}) - Run it under resource limits\n");
+    instance_->Output("  lastUsage() - CPU, memory and I/O of the last shell command\n");
     instance_->Output("  quit() - Exit console\n");
     instance_->Output("  help() - Show this help\n");
 }
 
 #else
 // Stub implementations when V8 is not available
+bool ClaudeConsole::WriteStartupSnapshot([[maybe_unused]] const std::string& path, std::string& error) {
+    error = "V8 not built";
+    return false;
+}
+
+bool ClaudeConsole::WriteInitSnapshot([[maybe_unused]] const std::string& path, std::string& error) {
+    error = "V8 not built";
+    return false;
+}
+
 bool ClaudeConsole::ExecuteFile(const std::string& path) {
     Output(std::format("JavaScript file execution not available (V8 not built): {}\n", path));
     return false;
@@ -1161,6 +2519,26 @@ bool ClaudeConsole::LoadDll(const std::string& path) {
     return false;
 }
 
+bool ClaudeConsole::LoadFileInBackground(const std::string& path) {
+    Output(std::format("JavaScript file execution not available (V8 not built): {}\n", path));
+    return false;
+}
+
+size_t ClaudeConsole::RunFinishedLoads([[maybe_unused]] bool wait) {
+    return 0;
+}
+
+size_t ClaudeConsole::PendingLoads() const {
+    return 0;
+}
+
+size_t ClaudeConsole::PumpMessageLoop() {
+    return 0;
+}
+
+void ClaudeConsole::RunIdleTasks() {
+}
+
 bool ClaudeConsole::UnloadDll(const std::string& path) {
     Output(std::format("DLL unloading not available (V8 not built): {}\n", path));
     return false;
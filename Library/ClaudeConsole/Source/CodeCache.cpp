@@ -0,0 +1,73 @@
+#include "CodeCache.h"
+#include "SourceManifest.h"
+#include <filesystem>
+#include <format>
+#include <fstream>
+#include <unistd.h>
+
+namespace cll {
+
+namespace fs = std::filesystem;
+
+CodeCache::CodeCache(std::string directory, std::string engineVersion)
+    : directory_(std::move(directory)), engineVersion_(std::move(engineVersion)) {
+}
+
+std::string CodeCache::PathFor(std::string_view source) const {
+    return std::format("{}/{:016x}.code", directory_, SourceManifest::Hash(source));
+}
+
+// "cll-code-cache <engine version> <source length>"
+std::string CodeCache::Header(std::string_view source) const {
+    return std::format("cll-code-cache {} {}\n", engineVersion_, source.size());
+}
+
+std::optional<std::string> CodeCache::Find(std::string_view source) {
+    std::ifstream file(PathFor(source), std::ios::binary);
+    std::string header;
+    if (!file || !std::getline(file, header) || header + "\n" != Header(source)) {
+        ++stats_.misses;
+        return std::nullopt;
+    }
+    std::string data(std::istreambuf_iterator<char>(file), {});
+    if (data.empty()) {
+        ++stats_.misses;
+        return std::nullopt;
+    }
+    stats_.bytesRead += data.size();
+    return data;
+}
+
+bool CodeCache::Store(std::string_view source, std::string_view data) {
+    std::error_code ec;
+    fs::create_directories(directory_, ec);
+    std::string path = PathFor(source);
+
+    // Written aside and renamed, so a concurrent session never reads half a file
+    std::string temp = std::format("{}.{}.tmp", path, getpid());
+    {
+        std::ofstream out(temp, std::ios::binary | std::ios::trunc);
+        out << Header(source);
+        out.write(data.data(), static_cast<std::streamsize>(data.size()));
+        if (!out) {
+            fs::remove(temp, ec);
+            return false;
+        }
+    }
+    fs::rename(temp, path, ec);
+    if (ec) {
+        fs::remove(temp, ec);
+        return false;
+    }
+    ++stats_.stored;
+    stats_.bytesWritten += data.size();
+    return true;
+}
+
+void CodeCache::Reject(std::string_view source) {
+    ++stats_.rejected;
+    std::error_code ec;
+    fs::remove(PathFor(source), ec);
+}
+
+} // namespace cll
@@ -0,0 +1,190 @@
+// Parsing and concurrent evaluation of `cmd` and $(cmd) substitutions
+#include "ClaudeConsole.h"
+#include <algorithm>
+#include <atomic>
+#include <format>
+#include <thread>
+
+namespace cll {
+
+namespace {
+
+// Index of the backtick closing the one at start, skipping \` escapes
+size_t FindClosingBacktick(const std::string& line, size_t start) {
+    for (size_t i = start + 1; i < line.size(); ++i) {
+        if (line[i] == '\\') {
+            ++i;
+        } else if (line[i] == '`') {
+            return i;
+        }
+    }
+    return std::string::npos;
+}
+
+// Index of the ')' matching the '(' at start. Quotes, escapes and nested
+// substitutions are stepped over; their contents are left to the shell.
+size_t FindClosingParen(const std::string& line, size_t start) {
+    int depth = 1;
+    for (size_t i = start + 1; i < line.size(); ++i) {
+        char c = line[i];
+        if (c == '\\') {
+            ++i;
+        } else if (c == '\'') {
+            i = line.find('\'', i + 1);
+            if (i == std::string::npos) return i;
+        } else if (c == '"') {
+            for (++i; i < line.size() && line[i] != '"'; ++i) {
+                if (line[i] == '\\') ++i;
+            }
+            if (i >= line.size()) return std::string::npos;
+        } else if (c == '`') {
+            i = FindClosingBacktick(line, i);
+            if (i == std::string::npos) return i;
+        } else if (c == '(') {
+            ++depth;
+        } else if (c == ')' && --depth == 0) {
+            return i;
+        }
+    }
+    return std::string::npos;
+}
+
+// Inside backticks, \` \$ and \\ stand for the character itself
+std::string UnescapeBackquoted(const std::string& text) {
+    std::string command;
+    for (size_t i = 0; i < text.size(); ++i) {
+        if (text[i] == '\\' && i + 1 < text.size() &&
+            (text[i + 1] == '`' || text[i + 1] == '$' || text[i + 1] == '\\')) {
+            ++i;
+        }
+        command += text[i];
+    }
+    return command;
+}
+
+} // namespace
+
+bool ClaudeConsole::ParseSubstitutions(const std::string& line, std::vector<SubstitutionPart>& parts) {
+    parts.clear();
+    std::string literal;
+    bool found = false;
+
+    auto addCommand = [&](std::string command) {
+        parts.push_back({std::move(literal), false});
+        literal.clear();
+        parts.push_back({std::move(command), true});
+        found = true;
+    };
+
+    for (size_t i = 0; i < line.size(); ++i) {
+        char c = line[i];
+        if (c == '\\' && i + 1 < line.size() && (line[i + 1] == '`' || line[i + 1] == '$')) {
+            // Escaped, so it stays for whoever reads the line next
+            literal += line.substr(i, 2);
+            ++i;
+            continue;
+        }
+
+        if (c == '\'') {
+            // A closed single-quoted string is taken as it is; a lone
+            // apostrophe, as in Ask mode prose, is just a character
+            size_t close = line.find('\'', i + 1);
+            if (close != std::string::npos) {
+                literal += line.substr(i, close - i + 1);
+                i = close;
+                continue;
+            }
+        } else if (c == '`') {
+            size_t close = FindClosingBacktick(line, i);
+            if (close != std::string::npos) {
+                addCommand(UnescapeBackquoted(line.substr(i + 1, close - i - 1)));
+                i = close;
+                continue;
+            }
+        } else if (c == '$' && line.compare(i, 2, "$(") == 0 && line.compare(i, 3, "$((") != 0) {
+            // $(( )) is arithmetic, not a command
+            size_t close = FindClosingParen(line, i + 1);
+            if (close != std::string::npos) {
+                addCommand(line.substr(i + 2, close - i - 2));
+                i = close;
+                continue;
+            }
+        }
+        literal += c;
+    }
+
+    if (!literal.empty()) {
+        parts.push_back({std::move(literal), false});
+    }
+    return found;
+}
+
+bool ClaudeConsole::ExpandSubstitutions(const std::string& line, std::string& expanded,
+                                        SubstitutionVariables& variables) {
+    std::vector<SubstitutionPart> parts;
+    if (!ParseSubstitutions(line, parts)) {
+        return false;
+    }
+
+    std::vector<size_t> commands;
+    for (size_t i = 0; i < parts.size(); ++i) {
+        if (parts[i].isCommand) {
+            commands.push_back(i);
+        }
+    }
+
+    // Each worker takes the next unstarted command until none are left;
+    // results land back in their own part, so order is kept
+    std::vector<std::string> errors(commands.size());
+    ProcessLimits limits = EffectiveLimits();
+    std::atomic<size_t> next{0};
+    auto worker = [&] {
+        for (size_t n; (n = next.fetch_add(1)) < commands.size();) {
+            SubstitutionPart& part = parts[commands[n]];
+            ProcessRequest request = ProcessRequest::Shell(part.text);
+            request.newProcessGroup = true;
+            request.timeout = shellTimeout_;
+            request.cancel = &cancel_;
+            request.limits = limits;
+            CommandResult result = executor_.Execute(request);
+            part.text = std::move(result.output);
+            errors[n] = std::move(result.error);
+
+            // Like the shell, drop all trailing newlines
+            part.text.erase(part.text.find_last_not_of('\n') + 1);
+        }
+    };
+
+    size_t workerCount = std::min(commands.size(), MaxSubstitutionWorkers);
+    std::vector<std::thread> workers;
+    for (size_t i = 1; i < workerCount; ++i) {
+        workers.emplace_back(worker);
+    }
+    worker();
+    for (auto& thread : workers) {
+        thread.join();
+    }
+
+    // stderr is not substituted; it goes to the terminal, as in a shell
+    for (const auto& error : errors) {
+        if (error.empty()) continue;
+        Error(error.back() == '\n' ? error : error + "\n");
+    }
+
+    // The line refers to each output by name rather than holding it, so
+    // the shell never parses it; ${ } behaves like $( ) in or out of quotes
+    expanded.clear();
+    variables.clear();
+    for (auto& part : parts) {
+        if (!part.isCommand) {
+            expanded += part.text;
+            continue;
+        }
+        std::string name = std::format("CLL_SUB_{}", variables.size());
+        expanded += "${" + name + "}";
+        variables.emplace_back(std::move(name), std::move(part.text));
+    }
+    return true;
+}
+
+} // namespace cll
@@ -0,0 +1,94 @@
+#pragma once
+
+// File descriptor helpers shared by the process-spawning sources
+#include <cerrno>
+#include <csignal>
+#include <cstddef>
+#include <ctime>
+#include <fcntl.h>
+#include <pthread.h>
+#include <unistd.h>
+
+namespace cll {
+
+// Owns a file descriptor and closes it on scope exit
+struct FdGuard {
+    int fd = -1;
+
+    FdGuard() = default;
+    explicit FdGuard(int f) : fd(f) {}
+    ~FdGuard() { Reset(); }
+    FdGuard(const FdGuard&) = delete;
+    FdGuard& operator=(const FdGuard&) = delete;
+
+    void Reset(int f = -1) {
+        if (fd >= 0) close(fd);
+        fd = f;
+    }
+
+    int Release() {
+        int f = fd;
+        fd = -1;
+        return f;
+    }
+};
+
+inline bool MakePipe(FdGuard& readEnd, FdGuard& writeEnd) {
+    int fds[2];
+    if (pipe2(fds, O_CLOEXEC) != 0) {
+        return false;
+    }
+    readEnd.Reset(fds[0]);
+    writeEnd.Reset(fds[1]);
+    return true;
+}
+
+inline void SetNonBlocking(int fd) {
+    int flags = fcntl(fd, F_GETFL);
+    if (flags >= 0) {
+        fcntl(fd, F_SETFL, flags | O_NONBLOCK);
+    }
+}
+
+// tcsetpgrp from a background group raises SIGTTOU unless it is blocked
+inline void SetTerminalGroup(pid_t group) {
+    sigset_t ttou, old;
+    sigemptyset(&ttou);
+    sigaddset(&ttou, SIGTTOU);
+    pthread_sigmask(SIG_BLOCK, &ttou, &old);
+    tcsetpgrp(STDIN_FILENO, group);
+    pthread_sigmask(SIG_SETMASK, &old, nullptr);
+}
+
+// Write a whole buffer to a blocking descriptor. A reader that has gone away
+// yields false instead of a process-killing SIGPIPE.
+inline bool WriteAll(int fd, const char* data, size_t size) {
+    sigset_t pipeSet, oldSet;
+    sigemptyset(&pipeSet);
+    sigaddset(&pipeSet, SIGPIPE);
+    pthread_sigmask(SIG_BLOCK, &pipeSet, &oldSet);
+
+    bool ok = true;
+    while (size > 0) {
+        ssize_t n = write(fd, data, size);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            ok = false;
+            break;
+        }
+        data += n;
+        size -= static_cast<size_t>(n);
+    }
+
+    if (!ok && errno == EPIPE) {
+        // Swallow the SIGPIPE that is now pending on this thread
+        timespec zero{0, 0};
+        int savedErrno = errno;
+        sigtimedwait(&pipeSet, nullptr, &zero);
+        errno = savedErrno;
+    }
+    pthread_sigmask(SIG_SETMASK, &oldSet, nullptr);
+    return ok;
+}
+
+} // namespace cll
@@ -0,0 +1,194 @@
+#include "JobTable.h"
+#include "ChildInterrupter.h"
+#include "FdUtil.h"
+#include <csignal>
+
+namespace cll {
+
+namespace {
+
+// Keep only the last OutputTailSize bytes of a stream
+void AppendTail(std::string& tail, std::string_view chunk) {
+    if (chunk.size() >= JobTable::OutputTailSize) {
+        tail.assign(chunk.substr(chunk.size() - JobTable::OutputTailSize));
+        return;
+    }
+    tail.append(chunk);
+    if (tail.size() > JobTable::OutputTailSize) {
+        tail.erase(0, tail.size() - JobTable::OutputTailSize);
+    }
+}
+
+} // namespace
+
+JobTable::JobTable(ProcessExecutor& executor)
+    : executor_(executor) {
+}
+
+JobTable::~JobTable() {
+    TerminateAll();
+}
+
+bool JobTable::Start(const std::string& command, JobInfo& job, std::string& error,
+                     const ProcessLimits& limits) {
+    auto startTime = std::chrono::high_resolution_clock::now();
+
+    // The job gets its own group so Ctrl-C at the prompt leaves it alone,
+    // and an empty stdin pipe so it never competes with the line editor
+    ProcessRequest request = ProcessRequest::Shell(command);
+    request.newProcessGroup = true;
+    request.pipeStdin = true;
+    request.limits = limits;
+
+    ChildProcess child;
+    if (!executor_.Spawn(request, child, error)) {
+        return false;
+    }
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto entry = std::make_unique<Job>();
+    entry->info.id = jobs_.empty() ? 1 : jobs_.rbegin()->first + 1;
+    entry->info.pid = child.pid;
+    entry->info.command = command;
+    Job* raw = entry.get();
+    raw->waiter = std::thread(&JobTable::Run, this, raw, std::move(request), child, startTime);
+    job = raw->info;
+    jobs_[job.id] = std::move(entry);
+    return true;
+}
+
+void JobTable::Run(Job* job, ProcessRequest request, ChildProcess child,
+                   std::chrono::high_resolution_clock::time_point startTime) {
+    std::string outputTail, errorTail;
+    request.onStdout = [&](std::string_view chunk) { AppendTail(outputTail, chunk); };
+    request.onStderr = [&](std::string_view chunk) { AppendTail(errorTail, chunk); };
+
+    CommandResult result = executor_.Collect(request, child, startTime);
+    result.output = std::move(outputTail);
+    result.error = std::move(errorTail);
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    job->result = std::move(result);
+    job->info.done = true;
+    changed_.notify_all();
+}
+
+JobReport JobTable::Remove(std::map<int, std::unique_ptr<Job>>::iterator it) {
+    Job& job = *it->second;
+    // The waiter has published its result and is on its way out
+    job.waiter.join();
+    JobReport report{job.info.id, job.info.command, std::move(job.result)};
+    jobs_.erase(it);
+    return report;
+}
+
+bool JobTable::Wait(int id, JobReport& report, const CancelToken* cancel) {
+    return WaitFor(id, report, cancel, false);
+}
+
+bool JobTable::Foreground(int id, JobReport& report, const CancelToken* cancel) {
+    return WaitFor(id, report, cancel, true);
+}
+
+bool JobTable::WaitFor(int id, JobReport& report, const CancelToken* cancel, bool foreground) {
+    std::unique_lock<std::mutex> lock(mutex_);
+    auto it = jobs_.find(id);
+    if (it == jobs_.end()) {
+        return false;
+    }
+
+    Job* job = it->second.get();
+    pid_t group = job->info.pid;
+    bool handedTerminal = false;
+    if (foreground && !job->info.done) {
+        handedTerminal = isatty(STDIN_FILENO) && tcgetpgrp(STDIN_FILENO) == getpgrp();
+        if (handedTerminal) {
+            SetTerminalGroup(group);
+        }
+        kill(-group, SIGCONT);
+    }
+
+    // In the foreground the job is interrupted and waited for; otherwise
+    // only the wait is
+    ChildInterrupter interrupter(-group, std::chrono::milliseconds(0), foreground ? cancel : nullptr);
+    bool cancelled = false;
+    while (!job->info.done) {
+        changed_.wait_for(lock, CancelPollInterval);
+        if (foreground) {
+            interrupter.Update();
+        } else if (cancel && cancel->IsCancelled()) {
+            cancelled = true;
+            break;
+        }
+    }
+
+    if (handedTerminal) {
+        SetTerminalGroup(getpgrp());
+    }
+
+    if (cancelled) {
+        report = {job->info.id, job->info.command, {false, "", "", std::chrono::microseconds(0), 130}};
+        report.result.cancelled = true;
+        return true;
+    }
+    report = Remove(jobs_.find(id));
+    report.result.cancelled = report.result.cancelled || interrupter.Cancelled();
+    return true;
+}
+
+bool JobTable::Continue(int id) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = jobs_.find(id);
+    if (it == jobs_.end() || it->second->info.done) {
+        return false;
+    }
+    return kill(-it->second->info.pid, SIGCONT) == 0;
+}
+
+std::vector<JobReport> JobTable::TakeFinished() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    std::vector<JobReport> finished;
+    for (auto it = jobs_.begin(); it != jobs_.end();) {
+        auto next = std::next(it);
+        if (it->second->info.done) {
+            finished.push_back(Remove(it));
+        }
+        it = next;
+    }
+    return finished;
+}
+
+std::vector<JobInfo> JobTable::List() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    std::vector<JobInfo> jobs;
+    for (const auto& [id, job] : jobs_) {
+        jobs.push_back(job->info);
+    }
+    return jobs;
+}
+
+int JobTable::Current() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return jobs_.empty() ? 0 : jobs_.rbegin()->first;
+}
+
+void JobTable::TerminateAll() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    for (const auto& [id, job] : jobs_) {
+        if (!job->info.done) {
+            kill(-job->info.pid, SIGHUP);
+            kill(-job->info.pid, SIGCONT);
+        }
+    }
+    changed_.wait(lock, [this] {
+        for (const auto& [id, job] : jobs_) {
+            if (!job->info.done) return false;
+        }
+        return true;
+    });
+    while (!jobs_.empty()) {
+        Remove(jobs_.begin());
+    }
+}
+
+} // namespace cll
@@ -0,0 +1,477 @@
+// Shell builtins that run inside the console process
+#include "ClaudeConsole.h"
+#include <algorithm>
+#include <cctype>
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <format>
+#include <glob.h>
+#include <set>
+#include <unistd.h>
+
+extern char** environ;
+
+namespace cll {
+
+namespace {
+
+// Characters that make a line need a real shell: pipes, lists (newlines
+// among them), redirections, subshells, expansions, escapes and globs
+constexpr const char* ShellSpecialChars = "|&;<>()$`\\*?[\n\r";
+
+// Pattern characters, which SplitSimpleCommand can expand itself
+constexpr const char* GlobChars = "*?[";
+
+bool IsValidVariableName(const std::string& name) {
+    if (name.empty() || std::isdigit(static_cast<unsigned char>(name[0]))) {
+        return false;
+    }
+    for (char c : name) {
+        if (!std::isalnum(static_cast<unsigned char>(c)) && c != '_') {
+            return false;
+        }
+    }
+    return true;
+}
+
+// Words the shell handles itself, which no PATH lookup would find
+bool IsShellWord(const std::string& name) {
+    static const std::set<std::string> shellWords = {
+        ".", ":", "[", "alias", "bg", "break", "case", "command", "continue", "do", "done",
+        "elif", "else", "esac", "eval", "exec", "exit", "false", "fc", "fg", "fi", "for",
+        "getopts", "if", "jobs", "kill", "local", "printf", "read", "readonly", "return", "set",
+        "shift", "test", "then", "times", "trap", "true", "type", "ulimit", "umask", "unalias",
+        "unset", "until", "wait", "while", "{", "}", "!"
+    };
+    return shellWords.count(name) > 0;
+}
+
+} // namespace
+
+bool ClaudeConsole::SplitSimpleCommand(const std::string& command, std::vector<std::string>& words,
+                                       bool expandGlobs) {
+    words.clear();
+    std::string word;
+    std::string pattern;
+    bool inWord = false;
+    bool hasGlob = false;
+
+    // Literal text, escaped in the glob pattern so quoting keeps it literal
+    auto addLiteral = [&](const std::string& text) {
+        word += text;
+        for (char c : text) {
+            if (std::strchr(GlobChars, c) || c == '\\') pattern += '\\';
+            pattern += c;
+        }
+    };
+
+    auto endWord = [&] {
+        glob_t matches{};
+        if (hasGlob && glob(pattern.c_str(), 0, nullptr, &matches) == 0) {
+            words.insert(words.end(), matches.gl_pathv, matches.gl_pathv + matches.gl_pathc);
+        } else {
+            // Like the shell, a pattern that matches nothing stays as typed
+            words.push_back(std::move(word));
+        }
+        if (hasGlob) globfree(&matches);
+        word.clear();
+        pattern.clear();
+        inWord = false;
+        hasGlob = false;
+    };
+
+    for (size_t i = 0; i < command.size(); ++i) {
+        char c = command[i];
+        if (c == ' ' || c == '\t') {
+            if (inWord) {
+                endWord();
+            }
+            continue;
+        }
+
+        if (!inWord) {
+            // Comments and ~user need the shell; a bare ~ or ~/ is HOME
+            if (c == '#') return false;
+            if (c == '~') {
+                bool endsWord = i + 1 == command.size() || command[i + 1] == '/' ||
+                                command[i + 1] == ' ' || command[i + 1] == '\t';
+                const char* home = std::getenv("HOME");
+                if (!endsWord || !home) return false;
+                addLiteral(home);
+                inWord = true;
+                continue;
+            }
+        }
+        inWord = true;
+
+        if (c == '\'' || c == '"') {
+            size_t close = command.find(c, i + 1);
+            if (close == std::string::npos) return false;
+            std::string quoted = command.substr(i + 1, close - i - 1);
+            // Double quotes still expand $, ` and backslashes
+            if (c == '"' && quoted.find_first_of("$`\\") != std::string::npos) return false;
+            addLiteral(quoted);
+            i = close;
+            continue;
+        }
+
+        if (expandGlobs && std::strchr(GlobChars, c)) {
+            word += c;
+            pattern += c;
+            hasGlob = true;
+            continue;
+        }
+        if (std::strchr(ShellSpecialChars, c)) return false;
+        addLiteral(std::string(1, c));
+    }
+
+    if (inWord) {
+        endWord();
+    }
+    return !words.empty();
+}
+
+bool ClaudeConsole::SplitPipeline(const std::string& command, std::vector<std::vector<std::string>>& stages) {
+    stages.clear();
+    size_t start = 0;
+    char quote = 0;
+    for (size_t i = 0; i <= command.size(); ++i) {
+        char c = i < command.size() ? command[i] : '|';
+        if (quote) {
+            if (c == quote) quote = 0;
+            continue;
+        }
+        if (c == '\'' || c == '"') {
+            quote = c;
+            continue;
+        }
+        if (c != '|') continue;
+
+        // "||" is a list, not a pipe
+        if (i + 1 < command.size() && command[i + 1] == '|') {
+            return false;
+        }
+        std::vector<std::string> words;
+        if (!SplitSimpleCommand(command.substr(start, i - start), words, true)) {
+            return false;
+        }
+        stages.push_back(std::move(words));
+        start = i + 1;
+    }
+    return stages.size() > 1;
+}
+
+bool ClaudeConsole::SplitStdinFeed(const std::string& command, std::string& rest) {
+    size_t feed = std::string::npos;
+    char quote = 0;
+    for (size_t i = 0; i < command.size(); ++i) {
+        char c = command[i];
+        if (quote) {
+            if (c == quote) quote = 0;
+        } else if (c == '\'' || c == '"') {
+            quote = c;
+        } else if (command.compare(i, 3, "<<<") == 0) {
+            feed = i;
+            i += 2;
+        }
+    }
+    if (feed == std::string::npos) {
+        return false;
+    }
+
+    size_t source = command.find_first_not_of(" \t", feed + 3);
+    if (source == std::string::npos || command.compare(source, 2, "$_") != 0 ||
+        command.find_first_not_of(" \t", source + 2) != std::string::npos) {
+        return false;
+    }
+    rest = command.substr(0, feed);
+    rest.erase(rest.find_last_not_of(" \t") + 1);
+    return !rest.empty();
+}
+
+bool ClaudeConsole::SplitLimitPrefix(const std::string& command, ProcessLimits& limits, std::string& rest,
+                                     std::string& error) {
+    size_t start = command.find_first_not_of(" \t");
+    if (start == std::string::npos || command.compare(start, 5, "limit") != 0 ||
+        (start + 5 < command.size() && command[start + 5] != ' ' && command[start + 5] != '\t')) {
+        return false;
+    }
+
+    // Options run up to "--" or the first word without '='; the command
+    // after them is kept as typed, quotes and all
+    size_t pos = start + 5;
+    while (true) {
+        size_t word = command.find_first_not_of(" \t", pos);
+        if (word == std::string::npos) {
+            error = "limit: missing command";
+            return true;
+        }
+        size_t end = std::min(command.find_first_of(" \t", word), command.size());
+        std::string_view option(command.data() + word, end - word);
+        if (option == "--") {
+            pos = end;
+            break;
+        }
+        if (option.find('=') == std::string_view::npos) {
+            pos = word;
+            break;
+        }
+        if (!limits.ParseOption(option, error)) {
+            return true;
+        }
+        pos = end;
+    }
+
+    size_t begin = command.find_first_not_of(" \t", pos);
+    if (begin == std::string::npos) {
+        error = "limit: missing command";
+        return true;
+    }
+    rest = command.substr(begin);
+    return true;
+}
+
+bool ClaudeConsole::IsNativePipeline(const std::string& command, std::vector<std::vector<std::string>>& stages) {
+    if (persistentShell_ || command.find('|') == std::string::npos || !SplitPipeline(command, stages)) {
+        return false;
+    }
+
+    // Every stage must be a program on PATH; builtins, keywords and
+    // assignments need the shell
+    for (const auto& words : stages) {
+        const std::string& name = words[0];
+        if (name.find('=') != std::string::npos || IsShellWord(name) ||
+            nativeBuiltins_.count(name) || builtinCommands_.count(name) || !pathCache_.Contains(name)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool ClaudeConsole::IsDirectCommand(const std::string& command, std::vector<std::string>& argv) {
+    if (persistentShell_ || !SplitSimpleCommand(command, argv, true)) {
+        return false;
+    }
+
+    // Builtins that declined the line, keywords and assignments need the shell
+    const std::string& name = argv[0];
+    return name.find('=') == std::string::npos && !IsShellWord(name) &&
+           !nativeBuiltins_.count(name) && !builtinCommands_.count(name) && pathCache_.Contains(name);
+}
+
+bool ClaudeConsole::IsNativeBuiltin(const std::string& command) const {
+    auto words = SplitCommand(command);
+    return !words.empty() && nativeBuiltins_.count(words[0]) > 0;
+}
+
+bool ClaudeConsole::TryNativeBuiltin(const std::string& command, CommandResult& result) {
+    auto startTime = std::chrono::high_resolution_clock::now();
+
+    if (persistentShell_ || !IsNativeBuiltin(command)) {
+        return false;
+    }
+
+    std::vector<std::string> words;
+    if (!SplitSimpleCommand(command, words)) {
+        return false;
+    }
+
+    result = {true, "", "", std::chrono::microseconds(0), 0};
+    if (!(this->*nativeBuiltins_.at(words[0]))(words, result)) {
+        return false;
+    }
+    result.success = (result.exitCode == 0);
+
+    // Round up so a builtin never reports that it took no time at all
+    result.executionTime = std::chrono::ceil<std::chrono::microseconds>(
+        std::chrono::high_resolution_clock::now() - startTime);
+    return true;
+}
+
+bool ClaudeConsole::BuiltinCd(const std::vector<std::string>& args, CommandResult& result) {
+    if (args.size() > 2) {
+        return false;
+    }
+
+    std::string target;
+    bool printTarget = false;
+    if (args.size() == 1) {
+        const char* home = std::getenv("HOME");
+        if (!home) {
+            result.error = "cd: HOME not set";
+            result.exitCode = 1;
+            return true;
+        }
+        target = home;
+    } else if (args[1] == "-") {
+        const char* previous = std::getenv("OLDPWD");
+        if (!previous) {
+            result.error = "cd: OLDPWD not set";
+            result.exitCode = 1;
+            return true;
+        }
+        target = previous;
+        printTarget = true;
+    } else if (!args[1].empty() && args[1][0] == '-') {
+        // Options such as -P are left to the shell
+        return false;
+    } else {
+        target = args[1];
+    }
+
+    char current[4096];
+    bool haveCurrent = getcwd(current, sizeof(current)) != nullptr;
+    if (chdir(target.c_str()) != 0) {
+        result.error = std::format("cd: {}: {}", target, std::strerror(errno));
+        result.exitCode = 1;
+        return true;
+    }
+
+    if (haveCurrent) {
+        setenv("OLDPWD", current, 1);
+    }
+    char now[4096];
+    if (getcwd(now, sizeof(now))) {
+        setenv("PWD", now, 1);
+        if (printTarget) {
+            result.output = std::string(now) + "\n";
+        }
+    }
+    return true;
+}
+
+bool ClaudeConsole::BuiltinPwd(const std::vector<std::string>& args, CommandResult& result) {
+    if (args.size() > 1) {
+        return false;
+    }
+
+    char current[4096];
+    if (!getcwd(current, sizeof(current))) {
+        result.error = std::format("pwd: {}", std::strerror(errno));
+        result.exitCode = 1;
+        return true;
+    }
+    result.output = std::string(current) + "\n";
+    return true;
+}
+
+bool ClaudeConsole::BuiltinExport(const std::vector<std::string>& args, CommandResult& result) {
+    // Listing the environment is left to the shell
+    if (args.size() == 1) {
+        return false;
+    }
+
+    for (size_t i = 1; i < args.size(); ++i) {
+        const std::string& arg = args[i];
+        size_t eq = arg.find('=');
+        std::string name = arg.substr(0, eq);
+        if (!IsValidVariableName(name)) {
+            if (!result.error.empty()) result.error += "\n";
+            result.error += std::format("export: {}: bad variable name", name);
+            result.exitCode = 1;
+            continue;
+        }
+        // "export NAME" only marks it; every variable here is already exported
+        if (eq != std::string::npos) {
+            setenv(name.c_str(), arg.c_str() + eq + 1, 1);
+        }
+    }
+    return true;
+}
+
+bool ClaudeConsole::BuiltinEcho(const std::vector<std::string>& args, CommandResult& result) {
+    size_t first = 1;
+    bool newline = true;
+    if (args.size() > 1 && args[1] == "-n") {
+        newline = false;
+        first = 2;
+    }
+
+    for (size_t i = first; i < args.size(); ++i) {
+        if (i > first) result.output += ' ';
+        result.output += args[i];
+    }
+    if (newline) {
+        result.output += '\n';
+    }
+    return true;
+}
+
+bool ClaudeConsole::BuiltinEnv(const std::vector<std::string>& args, CommandResult& result) {
+    // env with assignments or a command runs a program; leave that to the shell
+    if (args.size() > 1) {
+        return false;
+    }
+
+    for (char** entry = environ; *entry; ++entry) {
+        result.output += *entry;
+        result.output += '\n';
+    }
+    return true;
+}
+
+bool ClaudeConsole::BuiltinWhich(const std::vector<std::string>& args, CommandResult& result) {
+    for (size_t i = 1; i < args.size(); ++i) {
+        if (!args[i].empty() && args[i][0] == '-') {
+            return false;
+        }
+    }
+
+    for (size_t i = 1; i < args.size(); ++i) {
+        std::string found = pathCache_.Find(args[i]);
+        if (found.empty()) {
+            result.exitCode = 1;
+        } else {
+            result.output += found + "\n";
+        }
+    }
+    if (args.size() == 1) {
+        result.exitCode = 1;
+    }
+    return true;
+}
+
+bool ClaudeConsole::BuiltinHash(const std::vector<std::string>& args, CommandResult& result) {
+    if (args.size() == 2 && args[1] == "-r") {
+        pathCache_.Invalidate();
+        return true;
+    }
+
+    if (args.size() == 1) {
+        result.output = std::format("{} commands in {} PATH directories\n",
+                                    pathCache_.CommandCount(), pathCache_.DirectoryCount());
+        return true;
+    }
+
+    for (size_t i = 1; i < args.size(); ++i) {
+        if (!args[i].empty() && args[i][0] == '-') {
+            return false;
+        }
+        std::string found = pathCache_.Find(args[i]);
+        if (found.empty()) {
+            if (!result.error.empty()) result.error += "\n";
+            result.error += std::format("hash: {}: not found", args[i]);
+            result.exitCode = 1;
+        } else {
+            result.output += found + "\n";
+        }
+    }
+    return true;
+}
+
+bool ClaudeConsole::IsUnknownCommand(const std::string& command) {
+    // The persistent shell may have functions and aliases of its own
+    std::vector<std::string> words;
+    if (persistentShell_ || !SplitSimpleCommand(command, words)) {
+        return false;
+    }
+    const std::string& name = words[0];
+    if (name.find_first_of("/=") != std::string::npos || IsShellWord(name) ||
+        nativeBuiltins_.count(name) || builtinCommands_.count(name)) {
+        return false;
+    }
+    return !pathCache_.Contains(name);
+}
+
+} // namespace cll
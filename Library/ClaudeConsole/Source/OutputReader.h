@@ -0,0 +1,107 @@
+#pragma once
+
+// Bulk reads from child output pipes, shared by the executor's drain loops
+#include <algorithm>
+#include <cerrno>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <sys/ioctl.h>
+#include <unistd.h>
+#include "ProcessExecutor.h"
+
+namespace cll {
+
+// A ReadChunkSize buffer borrowed from a process-wide pool, so each command
+// does not allocate and fault in a fresh one
+class PooledReadBuffer {
+public:
+    static constexpr size_t MaxPooled = 8;
+
+    PooledReadBuffer() {
+        std::lock_guard<std::mutex> lock(PoolMutex());
+        auto& pool = Pool();
+        if (pool.empty()) {
+            buffer_ = std::make_unique_for_overwrite<char[]>(ProcessExecutor::ReadChunkSize);
+        } else {
+            buffer_ = std::move(pool.back());
+            pool.pop_back();
+        }
+    }
+
+    ~PooledReadBuffer() {
+        std::lock_guard<std::mutex> lock(PoolMutex());
+        if (Pool().size() < MaxPooled) {
+            Pool().push_back(std::move(buffer_));
+        }
+    }
+
+    PooledReadBuffer(const PooledReadBuffer&) = delete;
+    PooledReadBuffer& operator=(const PooledReadBuffer&) = delete;
+
+    char* Data() { return buffer_.get(); }
+    static constexpr size_t Size() { return ProcessExecutor::ReadChunkSize; }
+
+private:
+    static std::mutex& PoolMutex() {
+        static std::mutex mutex;
+        return mutex;
+    }
+
+    static std::vector<std::unique_ptr<char[]>>& Pool() {
+        static std::vector<std::unique_ptr<char[]>> pool;
+        return pool;
+    }
+
+    std::unique_ptr<char[]> buffer_;
+};
+
+// Capacity for a capture string that has filled up. Capacity that is never
+// written is only address space, so growing fourfold costs no memory and
+// recopies a third of the output rather than all of it; past a gigabyte
+// growth is linear, to keep the reservation sane.
+inline size_t GrownCapacity(size_t capacity) {
+    constexpr size_t LinearGrowth = size_t(1) << 30;
+    return std::min(capacity * 4, capacity + LinearGrowth);
+}
+
+// Read everything that is ready on a non-blocking pipe. With a sink, chunks
+// pass through the pooled buffer; without one they are read straight onto
+// the end of capture, sized by FIONREAD, so captured bytes are kept exactly,
+// NULs included, and never pass through a buffer. bytesRead (if given) is
+// advanced. Returns false once the pipe is at EOF or has failed.
+inline bool DrainOutput(int fd, const ProcessRequest::ChunkCallback& sink, std::string& capture,
+                        PooledReadBuffer& buffer, uint64_t* bytesRead = nullptr) {
+    while (true) {
+        ssize_t n;
+        if (sink) {
+            n = read(fd, buffer.Data(), buffer.Size());
+            if (n > 0) sink(std::string_view(buffer.Data(), static_cast<size_t>(n)));
+        } else {
+            int ready = 0;
+            size_t want = ProcessExecutor::ReadChunkSize;
+            if (ioctl(fd, FIONREAD, &ready) == 0 && ready > 0) {
+                want = std::max(want, static_cast<size_t>(ready));
+            }
+            size_t used = capture.size();
+            if (capture.capacity() < used + want) {
+                capture.reserve(std::max(used + want, GrownCapacity(capture.capacity())));
+            }
+            capture.resize(used + want);
+            n = read(fd, capture.data() + used, want);
+            capture.resize(used + static_cast<size_t>(std::max<ssize_t>(n, 0)));
+        }
+
+        if (n > 0) {
+            if (bytesRead) *bytesRead += static_cast<uint64_t>(n);
+            continue;
+        }
+        if (n < 0 && errno == EINTR) continue;
+        return n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK);
+    }
+}
+
+} // namespace cll
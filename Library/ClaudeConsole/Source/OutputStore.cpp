@@ -0,0 +1,178 @@
+#include "OutputStore.h"
+#include "FdUtil.h"
+#include "OutputReader.h"
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <format>
+#include <sys/mman.h>
+
+namespace cll {
+
+namespace {
+
+// Slice size for WriteTo; small enough that RSS stays flat
+constexpr size_t WriteSliceSize = 4 << 20;
+
+// An anonymous read-write file in the temp directory
+int CreateUnlinkedFile(std::string& error) {
+    std::error_code ec;
+    std::string dir = std::filesystem::temp_directory_path(ec).string();
+    if (ec) dir = "/tmp";
+
+    int fd = -1;
+#ifdef O_TMPFILE
+    fd = open(dir.c_str(), O_TMPFILE | O_RDWR | O_CLOEXEC, 0600);
+    if (fd >= 0) return fd;
+#endif
+
+    // Filesystems without O_TMPFILE: create a named file and unlink it
+    std::string path = dir + "/cll-output-XXXXXX";
+    fd = mkostemp(path.data(), O_CLOEXEC);
+    if (fd < 0) {
+        error = std::format("Cannot create spill file in {}: {}", dir, std::strerror(errno));
+        return -1;
+    }
+    unlink(path.c_str());
+    return fd;
+}
+
+} // namespace
+
+SpilledOutput::SpilledOutput(int fd, const char* data, size_t size)
+    : fd_(fd), data_(data), size_(size) {
+}
+
+SpilledOutput::~SpilledOutput() {
+    munmap(const_cast<char*>(data_), size_);
+    close(fd_);
+}
+
+std::shared_ptr<const SpilledOutput> SpilledOutput::Map(int fd, size_t size, std::string& error) {
+    void* data = mmap(nullptr, size, PROT_READ, MAP_SHARED, fd, 0);
+    if (data == MAP_FAILED) {
+        error = std::format("Cannot map spilled output: {}", std::strerror(errno));
+        close(fd);
+        return nullptr;
+    }
+    madvise(data, size, MADV_SEQUENTIAL);
+    return std::shared_ptr<const SpilledOutput>(new SpilledOutput(fd, static_cast<const char*>(data), size));
+}
+
+void SpilledOutput::WriteTo(std::ostream& out) const {
+    for (size_t offset = 0; offset < size_ && out; offset += WriteSliceSize) {
+        size_t length = std::min(WriteSliceSize, size_ - offset);
+        out.write(data_ + offset, static_cast<std::streamsize>(length));
+        // The file still has the data; only this process's pages go
+        madvise(const_cast<char*>(data_) + offset, length, MADV_DONTNEED);
+    }
+}
+
+OutputStore::OutputStore(size_t spillThreshold, OutputRetention retention, size_t retainBytes)
+    : threshold_(spillThreshold), retention_(retention), retainBytes_(retainBytes) {
+}
+
+OutputStore::~OutputStore() {
+    if (fd_ >= 0) close(fd_);
+}
+
+void OutputStore::Append(std::string_view chunk) {
+    if (retention_ != OutputRetention::All) {
+        size_ += chunk.size();
+        if (retention_ != OutputRetention::Tail && buffer_.size() < retainBytes_) {
+            size_t head = std::min(chunk.size(), retainBytes_ - buffer_.size());
+            buffer_.append(chunk.substr(0, head));
+            chunk.remove_prefix(head);
+        }
+        if (retention_ != OutputRetention::Head) {
+            AppendTail(chunk);
+        }
+        return;
+    }
+
+    if (fd_ < 0) {
+        if (buffer_.capacity() < buffer_.size() + chunk.size()) {
+            buffer_.reserve(std::max(buffer_.size() + chunk.size(), GrownCapacity(buffer_.capacity())));
+        }
+        buffer_.append(chunk);
+        size_ += chunk.size();
+        if (threshold_ > 0 && size_ > threshold_ && error_.empty()) {
+            Spill();
+        }
+        return;
+    }
+
+    // After a failed write the rest is dropped rather than kept in memory
+    if (!error_.empty()) return;
+    if (!WriteAll(fd_, chunk.data(), chunk.size())) {
+        error_ = std::format("Output truncated at {} bytes: {}", size_, std::strerror(errno));
+        return;
+    }
+    size_ += chunk.size();
+}
+
+void OutputStore::AppendTail(std::string_view chunk) {
+    if (retainBytes_ == 0 || chunk.empty()) {
+        return;
+    }
+    if (chunk.size() >= retainBytes_) {
+        tail_.assign(chunk.substr(chunk.size() - retainBytes_));
+        tailStart_ = 0;
+        return;
+    }
+
+    // Fill the ring, then overwrite the oldest bytes, wrapping at the end
+    if (tail_.size() < retainBytes_) {
+        size_t fill = std::min(chunk.size(), retainBytes_ - tail_.size());
+        tail_.append(chunk.substr(0, fill));
+        chunk.remove_prefix(fill);
+    }
+    while (!chunk.empty()) {
+        size_t n = std::min(chunk.size(), retainBytes_ - tailStart_);
+        std::memcpy(tail_.data() + tailStart_, chunk.data(), n);
+        tailStart_ = (tailStart_ + n) % retainBytes_;
+        chunk.remove_prefix(n);
+    }
+}
+
+bool OutputStore::Spill() {
+    int fd = CreateUnlinkedFile(error_);
+    if (fd < 0) {
+        return false;
+    }
+    if (!WriteAll(fd, buffer_.data(), buffer_.size())) {
+        // Nothing is lost yet, so stay in memory
+        error_ = std::format("Cannot write spill file: {}", std::strerror(errno));
+        close(fd);
+        return false;
+    }
+    fd_ = fd;
+    std::string().swap(buffer_);
+    return true;
+}
+
+void OutputStore::Finish(CommandResult& result) {
+    if (retention_ != OutputRetention::All) {
+        result.output = std::move(buffer_);
+        result.output.append(tail_, tailStart_, std::string::npos);
+        result.output.append(tail_, 0, tailStart_);
+        result.droppedBytes = size_ - result.output.size();
+    } else if (fd_ < 0) {
+        result.output = std::move(buffer_);
+    } else if (size_ > 0) {
+        std::string error;
+        result.spilledOutput = SpilledOutput::Map(fd_, size_, error);
+        fd_ = -1;
+        if (!error.empty() && error_.empty()) error_ = error;
+    }
+
+    if (!error_.empty()) {
+        if (!result.error.empty() && result.error.back() != '\n') {
+            result.error += '\n';
+        }
+        result.error += error_;
+    }
+}
+
+} // namespace cll
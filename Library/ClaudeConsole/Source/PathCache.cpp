@@ -0,0 +1,113 @@
+#include "PathCache.h"
+#include <cstdlib>
+#include <dirent.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace cll {
+
+namespace {
+
+bool IsExecutableFile(const std::string& path) {
+    struct stat info;
+    return stat(path.c_str(), &info) == 0 && S_ISREG(info.st_mode) && access(path.c_str(), X_OK) == 0;
+}
+
+bool SameTime(const timespec& a, const timespec& b) {
+    return a.tv_sec == b.tv_sec && a.tv_nsec == b.tv_nsec;
+}
+
+// Modification time of a directory; zero when it does not exist
+timespec DirectoryTime(const std::string& path) {
+    struct stat info;
+    if (stat(path.c_str(), &info) != 0 || !S_ISDIR(info.st_mode)) {
+        return timespec{0, 0};
+    }
+    return info.st_mtim;
+}
+
+} // namespace
+
+std::string PathCache::Find(const std::string& name) {
+    if (name.empty()) {
+        return "";
+    }
+    if (name.find('/') != std::string::npos) {
+        return IsExecutableFile(name) ? name : "";
+    }
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    RefreshLocked();
+    auto it = commands_.find(name);
+    return it == commands_.end() ? "" : it->second;
+}
+
+void PathCache::Invalidate() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    built_ = false;
+}
+
+size_t PathCache::CommandCount() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    RefreshLocked();
+    return commands_.size();
+}
+
+size_t PathCache::DirectoryCount() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    RefreshLocked();
+    return directories_.size();
+}
+
+bool PathCache::IsStaleLocked(const std::string& path) const {
+    if (!built_ || path != path_) {
+        return true;
+    }
+    for (const auto& directory : directories_) {
+        if (!SameTime(DirectoryTime(directory.path), directory.mtime)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+void PathCache::RefreshLocked() {
+    const char* pathVariable = std::getenv("PATH");
+    std::string path = pathVariable ? pathVariable : "";
+    if (!IsStaleLocked(path)) {
+        return;
+    }
+
+    path_ = path;
+    directories_.clear();
+    commands_.clear();
+
+    size_t start = 0;
+    while (start <= path.size()) {
+        size_t end = path.find(':', start);
+        if (end == std::string::npos) end = path.size();
+        std::string directory = path.substr(start, end - start);
+        start = end + 1;
+        if (directory.empty()) {
+            directory = ".";
+        }
+
+        // Take the time before listing, so changes made meanwhile show as stale
+        directories_.push_back({directory, DirectoryTime(directory)});
+        DIR* dir = opendir(directory.c_str());
+        if (!dir) continue;
+        while (dirent* entry = readdir(dir)) {
+            if (entry->d_type == DT_DIR || entry->d_name[0] == '.') continue;
+            // Earlier PATH entries win, as in the shell
+            if (commands_.count(entry->d_name)) continue;
+            std::string candidate = directory + "/" + entry->d_name;
+            if (IsExecutableFile(candidate)) {
+                commands_.emplace(entry->d_name, std::move(candidate));
+            }
+        }
+        closedir(dir);
+    }
+    built_ = true;
+}
+
+} // namespace cll
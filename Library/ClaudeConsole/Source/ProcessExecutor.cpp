@@ -0,0 +1,636 @@
+#include "ProcessExecutor.h"
+#include "SpawnServer.h"
+#include "PathCache.h"
+#include "FdUtil.h"
+#include "ChildInterrupter.h"
+#include "OutputReader.h"
+#include <cerrno>
+#include <cstring>
+#include <spawn.h>
+#include <poll.h>
+#include <sys/wait.h>
+#include <termios.h>
+
+extern char** environ;
+
+namespace cll {
+
+namespace {
+
+// Pipe size requested for pipeline boundaries; the default unprivileged
+// limit (/proc/sys/fs/pipe-max-size) is 1 MB
+constexpr int RelayPipeSize = 1 << 20;
+
+// One pipeline boundary: the upstream stage's stdout pipe and the
+// downstream stage's stdin pipe, joined by splice()
+struct Relay {
+    FdGuard source;
+    FdGuard sink;
+    bool sinkFull = false;
+};
+
+std::chrono::microseconds ToMicroseconds(const timeval& time) {
+    return std::chrono::seconds(time.tv_sec) + std::chrono::microseconds(time.tv_usec);
+}
+
+// Start a limited child with fork and exec; posix_spawn cannot run the
+// limits in between. Everything is prepared before the fork, since the
+// child of a threaded parent may only make system calls. Returns 0 or the
+// errno of the failed fork or exec, as posix_spawn does; a limit that
+// cannot be applied is reported on the child's stderr, exit code 127.
+int ForkWithLimits(pid_t& pid, const char* program, bool searchPath, char* const* argv,
+                   char* const* shellArgv, int stdinFd, int stdoutFd, int stderrFd,
+                   pid_t processGroup, bool newProcessGroup, const ProcessLimits& limits) {
+    FdGuard statusRead, statusWrite;
+    if (!MakePipe(statusRead, statusWrite)) {
+        return errno;
+    }
+
+    pid = fork();
+    if (pid < 0) {
+        return errno;
+    }
+    if (pid == 0) {
+        if (newProcessGroup || processGroup > 0) {
+            setpgid(0, newProcessGroup ? 0 : processGroup);
+        }
+        if (stdinFd >= 0) dup2(stdinFd, STDIN_FILENO);
+        dup2(stdoutFd, STDOUT_FILENO);
+        dup2(stderrFd, STDERR_FILENO);
+        if (!limits.ApplyToCurrentProcess()) {
+            _exit(127);
+        }
+        if (searchPath) {
+            // glibc's execvp runs scripts without a #! line itself
+            execvp(program, argv);
+        } else {
+            execv(program, argv);
+            if (errno == ENOEXEC) {
+                execv("/bin/sh", shellArgv);
+            }
+        }
+        int error = errno;
+        ssize_t ignored = write(statusWrite.fd, &error, sizeof(error));
+        (void)ignored;
+        _exit(127);
+    }
+
+    // The pipe closes at a successful exec, with nothing written
+    statusWrite.Reset();
+    int error = 0;
+    ssize_t n;
+    while ((n = read(statusRead.fd, &error, sizeof(error))) < 0 && errno == EINTR) {
+    }
+    if (n == sizeof(error)) {
+        waitpid(pid, nullptr, 0);
+        return error;
+    }
+    return 0;
+}
+
+} // namespace
+
+ProcessRequest ProcessRequest::Shell(const std::string& command) {
+    ProcessRequest request;
+    request.argv = {"/bin/sh", "-c", command};
+    return request;
+}
+
+ProcessExecutor::ProcessExecutor() = default;
+
+ProcessExecutor::~ProcessExecutor() = default;
+
+bool ProcessExecutor::StartServer() {
+    if (!server_) {
+        server_ = std::make_unique<SpawnServer>();
+    }
+    return server_->Start();
+}
+
+void ProcessExecutor::StopServer() {
+    server_.reset();
+}
+
+bool ProcessExecutor::UsesServer() const {
+    return server_ && server_->IsRunning();
+}
+
+CommandResult ProcessExecutor::ExecuteShell(const std::string& command) {
+    return Execute(ProcessRequest::Shell(command));
+}
+
+int ProcessExecutor::DecodeWaitStatus(int status) {
+    if (WIFEXITED(status)) {
+        return WEXITSTATUS(status);
+    }
+    if (WIFSIGNALED(status)) {
+        return 128 + WTERMSIG(status);
+    }
+    return 1;
+}
+
+ResourceUsage ProcessExecutor::DecodeResourceUsage(const rusage& usage) {
+    ResourceUsage decoded;
+    decoded.measured = true;
+    decoded.userTime = ToMicroseconds(usage.ru_utime);
+    decoded.systemTime = ToMicroseconds(usage.ru_stime);
+    decoded.maxRssKb = usage.ru_maxrss;
+    decoded.voluntarySwitches = usage.ru_nvcsw;
+    decoded.involuntarySwitches = usage.ru_nivcsw;
+    decoded.bytesRead = static_cast<uint64_t>(usage.ru_inblock) * 512;
+    decoded.bytesWritten = static_cast<uint64_t>(usage.ru_oublock) * 512;
+    return decoded;
+}
+
+bool ProcessExecutor::Spawn(const ProcessRequest& request, ChildProcess& child, std::string& error) {
+    if (pathCache_ && request.program.empty() && !request.argv.empty() &&
+        request.argv[0].find('/') == std::string::npos) {
+        ProcessRequest resolved = request;
+        resolved.program = pathCache_->Find(request.argv[0]);
+        if (resolved.program.empty()) {
+            error = "Failed to execute " + request.argv[0] + ": " + std::strerror(ENOENT);
+            return false;
+        }
+        return Spawn(resolved, child, error);
+    }
+    
+    if (UsesServer() && !request.argv.empty()) {
+        std::string serverError;
+        if (server_->Spawn(request, child, serverError)) {
+            return true;
+        }
+        // A command that could not be started fails the same way locally;
+        // anything else (server gone, request too large) falls through
+        if (server_->IsRunning() && serverError.starts_with("Failed to execute")) {
+            error = serverError;
+            return false;
+        }
+    }
+    return SpawnLocal(request, child, error);
+}
+
+bool ProcessExecutor::SpawnLocal(const ProcessRequest& request, ChildProcess& child, std::string& error) {
+    if (request.argv.empty()) {
+        error = "Failed to execute command: empty command";
+        return false;
+    }
+
+    FdGuard inRead, inWrite, outRead, outWrite, errRead, errWrite;
+    bool pipeIn = request.stdinFd < 0 && request.pipeStdin;
+    bool pipeOut = request.stdoutFd < 0;
+    bool pipeErr = request.stderrFd < 0 && !request.mergeStderr;
+    if ((pipeIn && !MakePipe(inRead, inWrite)) ||
+        (pipeOut && !MakePipe(outRead, outWrite)) ||
+        (pipeErr && !MakePipe(errRead, errWrite))) {
+        error = std::string("Failed to create pipe: ") + std::strerror(errno);
+        return false;
+    }
+    int stdinFd = request.stdinFd >= 0 ? request.stdinFd : pipeIn ? inRead.fd : -1;
+    int stdoutFd = pipeOut ? outWrite.fd : request.stdoutFd;
+    int stderrFd = request.stderrFd >= 0 ? request.stderrFd : request.mergeStderr ? stdoutFd : errWrite.fd;
+
+    // Wire the child's ends onto its stdio; everything else is O_CLOEXEC
+    // and disappears at exec
+    posix_spawn_file_actions_t actions;
+    posix_spawn_file_actions_init(&actions);
+    if (stdinFd >= 0) {
+        posix_spawn_file_actions_adddup2(&actions, stdinFd, STDIN_FILENO);
+    }
+    posix_spawn_file_actions_adddup2(&actions, stdoutFd, STDOUT_FILENO);
+    posix_spawn_file_actions_adddup2(&actions, stderrFd, STDERR_FILENO);
+
+    posix_spawnattr_t attributes;
+    posix_spawnattr_init(&attributes);
+    if (request.newProcessGroup || request.processGroup > 0) {
+        posix_spawnattr_setflags(&attributes, POSIX_SPAWN_SETPGROUP);
+        posix_spawnattr_setpgroup(&attributes, request.newProcessGroup ? 0 : request.processGroup);
+    }
+
+    std::vector<char*> argv;
+    argv.reserve(request.argv.size() + 1);
+    for (const auto& arg : request.argv) {
+        argv.push_back(const_cast<char*>(arg.c_str()));
+    }
+    argv.push_back(nullptr);
+
+    pid_t pid = -1;
+    const std::string& program = request.program.empty() ? request.argv[0] : request.program;
+    bool searchPath = program.find('/') == std::string::npos;
+    // A script without a #! line is run by the shell, as execvp would
+    std::vector<char*> shellArgv = {const_cast<char*>("sh"), const_cast<char*>(program.c_str())};
+    shellArgv.insert(shellArgv.end(), argv.begin() + 1, argv.end());
+    int rc;
+    if (!request.limits.Empty()) {
+        rc = ForkWithLimits(pid, program.c_str(), searchPath, argv.data(), shellArgv.data(),
+                            stdinFd, stdoutFd, stderrFd, request.processGroup,
+                            request.newProcessGroup, request.limits);
+    } else {
+        rc = searchPath
+            ? posix_spawnp(&pid, program.c_str(), &actions, &attributes, argv.data(), environ)
+            : posix_spawn(&pid, program.c_str(), &actions, &attributes, argv.data(), environ);
+        if (rc == ENOEXEC) {
+            rc = posix_spawn(&pid, "/bin/sh", &actions, &attributes, shellArgv.data(), environ);
+        }
+    }
+    posix_spawn_file_actions_destroy(&actions);
+    posix_spawnattr_destroy(&attributes);
+
+    if (rc != 0) {
+        error = "Failed to execute " + program + ": " + std::strerror(rc);
+        return false;
+    }
+
+    // Hand the parent's ends over; the child's ends close with the guards
+    child.pid = pid;
+    child.stdinFd = inWrite.Release();
+    child.stdoutFd = outRead.Release();
+    child.stderrFd = errRead.Release();
+    return true;
+}
+
+int ProcessExecutor::Wait(const ChildProcess& child, rusage* usage) {
+    if (child.viaServer && server_) {
+        return DecodeWaitStatus(server_->Wait(child.pid, usage));
+    }
+
+    int status = 0;
+    while (wait4(child.pid, &status, 0, usage) < 0) {
+        if (errno != EINTR) return 1;
+    }
+    return DecodeWaitStatus(status);
+}
+
+CommandResult ProcessExecutor::Execute(const ProcessRequest& request) {
+    auto startTime = std::chrono::high_resolution_clock::now();
+
+    ChildProcess child;
+    std::string spawnError;
+    if (!Spawn(request, child, spawnError)) {
+        return {false, "", spawnError, std::chrono::microseconds(0), 127};
+    }
+
+    return Collect(request, child, startTime);
+}
+
+CommandResult ProcessExecutor::Collect(const ProcessRequest& request, ChildProcess& child,
+                                       std::chrono::high_resolution_clock::time_point startTime) {
+    // Only the child keeps the write ends, so EOF arrives when it exits
+    FdGuard inWrite(child.stdinFd), outRead(child.stdoutFd), errRead(child.stderrFd);
+
+    // stdin gets the request's data, if any, then EOF. A child that stops
+    // reading early makes the write fail with EPIPE, and the SIGPIPE that
+    // comes with it is blocked and swallowed.
+    std::string_view input = request.stdinData;
+    sigset_t pipeSet, oldSet;
+    sigemptyset(&pipeSet);
+    sigaddset(&pipeSet, SIGPIPE);
+    if (input.empty()) {
+        inWrite.Reset();
+    } else if (inWrite.fd >= 0) {
+        pthread_sigmask(SIG_BLOCK, &pipeSet, &oldSet);
+        fcntl(inWrite.fd, F_SETPIPE_SZ, StdinPipeSize);
+        SetNonBlocking(inWrite.fd);
+    }
+    bool feeding = inWrite.fd >= 0;
+
+    CommandResult result;
+    PooledReadBuffer buffer;
+
+    struct Stream {
+        FdGuard* fd;
+        const ProcessRequest::ChunkCallback* sink;
+        std::string* capture;
+    };
+    Stream streams[2] = {
+        {&outRead, &request.onStdout, &result.output},
+        {&errRead, &request.onStderr, &result.error}
+    };
+
+    for (auto& stream : streams) {
+        if (stream.fd->fd >= 0) SetNonBlocking(stream.fd->fd);
+    }
+
+    ChildInterrupter interrupter(request.newProcessGroup ? -child.pid : child.pid,
+                                 request.timeout, request.cancel);
+
+    bool handedTerminal = request.takeTerminal && request.newProcessGroup &&
+        isatty(STDIN_FILENO) && tcgetpgrp(STDIN_FILENO) == getpgrp();
+    if (handedTerminal) {
+        SetTerminalGroup(child.pid);
+        // It may already have stopped on a terminal read before it owned it
+        kill(-child.pid, SIGCONT);
+    }
+
+    while (outRead.fd >= 0 || errRead.fd >= 0 || inWrite.fd >= 0) {
+        pollfd fds[4];
+        nfds_t count = 0;
+        Stream* polled[2];
+        for (auto& stream : streams) {
+            if (stream.fd->fd >= 0) {
+                fds[count] = {stream.fd->fd, POLLIN, 0};
+                polled[count++] = &stream;
+            }
+        }
+        nfds_t streamCount = count;
+        nfds_t inputIndex = count;
+        if (inWrite.fd >= 0) {
+            fds[count++] = {inWrite.fd, POLLOUT, 0};
+        }
+        if (interrupter.CancelFd() >= 0) {
+            fds[count++] = {interrupter.CancelFd(), POLLIN, 0};
+        }
+
+        if (poll(fds, count, interrupter.PollTimeout()) < 0) {
+            if (errno == EINTR) continue;
+            break;
+        }
+        if (!interrupter.Update()) {
+            break;
+        }
+
+        for (nfds_t i = 0; i < streamCount; ++i) {
+            if (!(fds[i].revents & (POLLIN | POLLHUP | POLLERR))) continue;
+
+            Stream& stream = *polled[i];
+            // Drain everything that is ready before polling again
+            if (!DrainOutput(stream.fd->fd, *stream.sink, *stream.capture, buffer)) {
+                stream.fd->Reset();
+            }
+        }
+
+        if (inWrite.fd >= 0 && (fds[inputIndex].revents & (POLLOUT | POLLHUP | POLLERR))) {
+            // Fill the pipe; the rest waits for the child to read
+            while (!input.empty()) {
+                ssize_t n = write(inWrite.fd, input.data(), input.size());
+                if (n > 0) {
+                    input.remove_prefix(static_cast<size_t>(n));
+                    continue;
+                }
+                if (n < 0 && errno == EINTR) continue;
+                if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) break;
+                // The child closed its stdin; it gets no more
+                input = {};
+            }
+            if (input.empty()) {
+                inWrite.Reset();
+            }
+        }
+    }
+    inWrite.Reset();
+    outRead.Reset();
+    errRead.Reset();
+    if (feeding) {
+        timespec zero{0, 0};
+        while (sigtimedwait(&pipeSet, nullptr, &zero) > 0) {
+        }
+        pthread_sigmask(SIG_SETMASK, &oldSet, nullptr);
+    }
+
+    rusage usage{};
+    result.exitCode = Wait(child, &usage);
+    result.usage = DecodeResourceUsage(usage);
+    child = ChildProcess{};
+    if (handedTerminal) {
+        SetTerminalGroup(getpgrp());
+    }
+    result.timedOut = interrupter.TimedOut();
+    result.cancelled = interrupter.Cancelled();
+    result.success = (result.exitCode == 0) && !interrupter.Interrupted();
+    result.executionTime = std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::high_resolution_clock::now() - startTime);
+
+    return result;
+}
+
+CommandResult ProcessExecutor::ExecutePipeline(const std::vector<std::vector<std::string>>& stages,
+                                               const ProcessRequest& options) {
+    using Clock = std::chrono::high_resolution_clock;
+    auto startTime = Clock::now();
+
+    if (stages.empty()) {
+        return {false, "", "Failed to execute command: empty pipeline", std::chrono::microseconds(0), 127};
+    }
+
+    // Every pipe exists before anything is spawned, so a failure here
+    // leaves nothing to clean up
+    size_t count = stages.size();
+    std::vector<FdGuard> stageIn(count), stageOut(count);
+    std::vector<Relay> relays(count - 1);
+    FdGuard outRead, errRead, errWrite;
+    bool piped = MakePipe(errRead, errWrite);
+    for (size_t i = 0; piped && i < count; ++i) {
+        if (i + 1 < count) {
+            piped = MakePipe(relays[i].source, stageOut[i]) && MakePipe(stageIn[i + 1], relays[i].sink);
+        } else {
+            piped = MakePipe(outRead, stageOut[i]);
+        }
+    }
+    if (!piped) {
+        return {false, "", std::string("Failed to create pipe: ") + std::strerror(errno),
+                std::chrono::microseconds(0), 127};
+    }
+
+    CommandResult result{false, "", "", std::chrono::microseconds(0), 0};
+    result.stages.resize(count);
+    auto reportError = [&](const std::string& text) {
+        if (options.onStderr) {
+            options.onStderr(text + "\n");
+        } else {
+            result.error += text + "\n";
+        }
+    };
+
+    // The first stage to start leads the group the others join. A stage
+    // that cannot start is reported and the rest still run, as in the shell.
+    std::vector<ChildProcess> children(count);
+    std::vector<Clock::time_point> spawned(count), finished(count);
+    pid_t group = 0;
+    for (size_t i = 0; i < count; ++i) {
+        StageStats& stats = result.stages[i];
+        for (const auto& word : stages[i]) {
+            if (!stats.command.empty()) stats.command += ' ';
+            stats.command += word;
+        }
+
+        ProcessRequest request;
+        request.argv = stages[i];
+        request.stdinFd = stageIn[i].fd;
+        request.stdoutFd = stageOut[i].fd;
+        request.stderrFd = errWrite.fd;
+        request.newProcessGroup = group == 0;
+        request.processGroup = group;
+        request.limits = options.limits;
+
+        spawned[i] = Clock::now();
+        finished[i] = Clock::time_point{};
+        std::string error;
+        if (Spawn(request, children[i], error)) {
+            if (group == 0) group = children[i].pid;
+        } else {
+            stats.exitCode = 127;
+            reportError(error);
+        }
+        // Only the stage holds its ends from here on
+        stageIn[i].Reset();
+        stageOut[i].Reset();
+    }
+    errWrite.Reset();
+
+    if (group == 0) {
+        result.exitCode = result.stages.back().exitCode;
+        result.executionTime = std::chrono::duration_cast<std::chrono::microseconds>(Clock::now() - startTime);
+        return result;
+    }
+
+    bool handedTerminal = options.takeTerminal && isatty(STDIN_FILENO) && tcgetpgrp(STDIN_FILENO) == getpgrp();
+    if (handedTerminal) {
+        SetTerminalGroup(group);
+        kill(-group, SIGCONT);
+    }
+
+    // A stage that stops reading makes splice() fail with EPIPE; block the
+    // SIGPIPE that comes with it (only now, so the stages do not inherit it)
+    sigset_t pipeSet, oldSet;
+    sigemptyset(&pipeSet);
+    sigaddset(&pipeSet, SIGPIPE);
+    pthread_sigmask(SIG_BLOCK, &pipeSet, &oldSet);
+
+    // Bigger relay pipes mean fewer wakeups per byte moved
+    for (auto& relay : relays) {
+        SetNonBlocking(relay.source.fd);
+        SetNonBlocking(relay.sink.fd);
+        fcntl(relay.source.fd, F_SETPIPE_SZ, RelayPipeSize);
+        fcntl(relay.sink.fd, F_SETPIPE_SZ, RelayPipeSize);
+    }
+    SetNonBlocking(outRead.fd);
+    SetNonBlocking(errRead.fd);
+
+    auto closeRelay = [&](size_t i) {
+        relays[i].source.Reset();
+        relays[i].sink.Reset();
+        finished[i] = Clock::now();
+    };
+
+    // Move whatever the boundary can take; on EAGAIN work out whether the
+    // source is empty or the sink is full, and wait for the right side
+    auto pump = [&](size_t i) {
+        Relay& relay = relays[i];
+        while (true) {
+            ssize_t n = splice(relay.source.fd, nullptr, relay.sink.fd, nullptr, RelayPipeSize,
+                               SPLICE_F_MOVE | SPLICE_F_NONBLOCK);
+            if (n > 0) {
+                result.stages[i].bytesOut += static_cast<uint64_t>(n);
+                continue;
+            }
+            if (n < 0 && errno == EINTR) continue;
+            if (n < 0 && errno == EAGAIN) {
+                pollfd sink{relay.sink.fd, POLLOUT, 0};
+                int ready = poll(&sink, 1, 0);
+                if (ready > 0 && (sink.revents & POLLERR)) {
+                    closeRelay(i);
+                } else {
+                    relay.sinkFull = ready == 0;
+                }
+                return;
+            }
+            // EOF, or EPIPE: the next stage is gone, and closing our end
+            // passes that on upstream
+            closeRelay(i);
+            return;
+        }
+    };
+
+    PooledReadBuffer buffer;
+    auto drain = [&](FdGuard& fd, const ProcessRequest::ChunkCallback& sink, std::string& capture) {
+        uint64_t* bytes = &fd == &outRead ? &result.stages.back().bytesOut : nullptr;
+        if (DrainOutput(fd.fd, sink, capture, buffer, bytes)) {
+            return;
+        }
+        fd.Reset();
+        if (&fd == &outRead) {
+            finished[count - 1] = Clock::now();
+        }
+    };
+
+    ChildInterrupter interrupter(-group, options.timeout, options.cancel);
+    std::vector<pollfd> fds;
+    std::vector<size_t> owners;     // relay index, or count for stdout, count + 1 for stderr
+    while (true) {
+        fds.clear();
+        owners.clear();
+        for (size_t i = 0; i < relays.size(); ++i) {
+            if (relays[i].source.fd < 0) continue;
+            fds.push_back(relays[i].sinkFull ? pollfd{relays[i].sink.fd, POLLOUT, 0}
+                                             : pollfd{relays[i].source.fd, POLLIN, 0});
+            owners.push_back(i);
+        }
+        if (outRead.fd >= 0) {
+            fds.push_back({outRead.fd, POLLIN, 0});
+            owners.push_back(count);
+        }
+        if (errRead.fd >= 0) {
+            fds.push_back({errRead.fd, POLLIN, 0});
+            owners.push_back(count + 1);
+        }
+        if (fds.empty()) break;
+
+        size_t streamCount = fds.size();
+        if (interrupter.CancelFd() >= 0) {
+            fds.push_back({interrupter.CancelFd(), POLLIN, 0});
+        }
+
+        if (poll(fds.data(), fds.size(), interrupter.PollTimeout()) < 0) {
+            if (errno == EINTR) continue;
+            break;
+        }
+        if (!interrupter.Update()) {
+            break;
+        }
+
+        for (size_t k = 0; k < streamCount; ++k) {
+            if (!(fds[k].revents & (POLLIN | POLLOUT | POLLHUP | POLLERR))) continue;
+            size_t owner = owners[k];
+            if (owner < relays.size()) {
+                pump(owner);
+            } else if (owner == count) {
+                drain(outRead, options.onStdout, result.output);
+            } else {
+                drain(errRead, options.onStderr, result.error);
+            }
+        }
+    }
+    relays.clear();
+    outRead.Reset();
+    errRead.Reset();
+
+    // Swallow any SIGPIPE left pending before unblocking it
+    timespec zero{0, 0};
+    while (sigtimedwait(&pipeSet, nullptr, &zero) > 0) {
+    }
+    pthread_sigmask(SIG_SETMASK, &oldSet, nullptr);
+
+    for (size_t i = 0; i < count; ++i) {
+        if (children[i].pid <= 0) continue;
+        rusage usage{};
+        result.stages[i].exitCode = Wait(children[i], &usage);
+        ResourceUsage stageUsage = DecodeResourceUsage(usage);
+        result.stages[i].cpuTime = stageUsage.userTime + stageUsage.systemTime;
+        result.usage.Add(stageUsage);
+        if (finished[i] == Clock::time_point{}) {
+            finished[i] = Clock::now();
+        }
+        result.stages[i].wallTime = std::chrono::duration_cast<std::chrono::microseconds>(finished[i] - spawned[i]);
+    }
+    if (handedTerminal) {
+        SetTerminalGroup(getpgrp());
+    }
+
+    result.exitCode = result.stages.back().exitCode;
+    result.timedOut = interrupter.TimedOut();
+    result.cancelled = interrupter.Cancelled();
+    result.success = (result.exitCode == 0) && !interrupter.Interrupted();
+    result.executionTime = std::chrono::duration_cast<std::chrono::microseconds>(Clock::now() - startTime);
+    return result;
+}
+
+} // namespace cll
@@ -0,0 +1,210 @@
+#include "ProcessLimits.h"
+#include <algorithm>
+#include <cerrno>
+#include <charconv>
+#include <cstring>
+#include <format>
+#include <fcntl.h>
+#include <pthread.h>
+#include <unistd.h>
+
+namespace cll {
+
+namespace {
+
+constexpr std::string_view CgroupRoot = "/sys/fs/cgroup";
+
+template <typename T>
+bool ParseNumber(std::string_view text, T& value) {
+    auto [end, ec] = std::from_chars(text.data(), text.data() + text.size(), value);
+    return ec == std::errc() && end == text.data() + text.size();
+}
+
+// "512M" and the like; a bare number is bytes
+bool ParseByteSize(std::string_view text, rlim_t& bytes) {
+    rlim_t scale = 1;
+    if (!text.empty()) {
+        switch (text.back()) {
+            case 'K': case 'k': scale = rlim_t(1) << 10; break;
+            case 'M': case 'm': scale = rlim_t(1) << 20; break;
+            case 'G': case 'g': scale = rlim_t(1) << 30; break;
+        }
+        if (scale != 1) text.remove_suffix(1);
+    }
+    rlim_t count = 0;
+    if (!ParseNumber(text, count) || count > RLIM_INFINITY / scale) {
+        return false;
+    }
+    bytes = count * scale;
+    return true;
+}
+
+// The largest unit that divides bytes exactly, so Describe() round-trips
+std::string FormatByteSize(rlim_t bytes) {
+    for (auto [shift, suffix] : {std::pair{30, 'G'}, std::pair{20, 'M'}, std::pair{10, 'K'}}) {
+        rlim_t unit = rlim_t(1) << shift;
+        if (bytes % unit == 0) return std::format("{}{}", bytes / unit, suffix);
+    }
+    return std::to_string(bytes);
+}
+
+// "cll: what: reason" on stderr without allocating, for forked children
+void ReportFailure(const char* what, int error) {
+    const char* reason = std::strerror(error);
+    for (const char* part : {"cll: ", what, ": ", reason, "\n"}) {
+        ssize_t ignored = write(STDERR_FILENO, part, std::strlen(part));
+        (void)ignored;
+    }
+}
+
+// Lower both the soft and the hard limit; an unprivileged process cannot
+// raise its hard limit, so a request above it gets the hard limit
+bool LowerLimit(int resource, rlim_t soft, rlim_t hard) {
+    rlimit current;
+    if (getrlimit(resource, &current) == 0 && current.rlim_max != RLIM_INFINITY) {
+        soft = std::min(soft, current.rlim_max);
+        hard = std::min(hard, current.rlim_max);
+    }
+    rlimit limit{soft, hard};
+    return setrlimit(resource, &limit) == 0;
+}
+
+} // namespace
+
+bool ProcessLimits::Empty() const {
+    return nice == 0 && !cpus && addressSpace == 0 && cpuSeconds == 0 && cgroup.empty();
+}
+
+void ProcessLimits::Merge(const ProcessLimits& other) {
+    if (other.nice != 0) nice = other.nice;
+    if (other.cpus) cpus = other.cpus;
+    if (other.addressSpace != 0) addressSpace = other.addressSpace;
+    if (other.cpuSeconds != 0) cpuSeconds = other.cpuSeconds;
+    if (!other.cgroup.empty()) cgroup = other.cgroup;
+}
+
+bool ProcessLimits::ParseOption(std::string_view option, std::string& error) {
+    size_t eq = option.find('=');
+    std::string_view key = option.substr(0, eq);
+    std::string_view value = eq == std::string_view::npos ? std::string_view() : option.substr(eq + 1);
+    if (eq == std::string_view::npos || value.empty()) {
+        error = std::format("limit: expected key=value, got '{}'", option);
+        return false;
+    }
+
+    bool parsed = false;
+    if (key == "nice") {
+        // from_chars takes no leading '+'
+        if (value.front() == '+') value.remove_prefix(1);
+        parsed = ParseNumber(value, nice) && nice >= -40 && nice <= 40;
+    } else if (key == "cpus") {
+        cpu_set_t set;
+        parsed = ParseCpuList(value, set);
+        if (parsed) cpus = set;
+    } else if (key == "mem") {
+        parsed = ParseByteSize(value, addressSpace) && addressSpace > 0;
+    } else if (key == "cputime") {
+        parsed = ParseNumber(value, cpuSeconds) && cpuSeconds > 0;
+    } else if (key == "cgroup") {
+        cgroup = value.front() == '/' ? std::string(value) : std::format("{}/{}", CgroupRoot, value);
+        parsed = true;
+    } else {
+        error = std::format("limit: unknown option '{}' (nice, cpus, mem, cputime, cgroup)", key);
+        return false;
+    }
+    if (!parsed) {
+        error = std::format("limit: bad value for {}: '{}'", key, value);
+    }
+    return parsed;
+}
+
+std::string ProcessLimits::Describe() const {
+    std::string text;
+    auto add = [&text](const std::string& option) {
+        if (!text.empty()) text += ' ';
+        text += option;
+    };
+    if (nice != 0) add(std::format("nice={}", nice));
+    if (cpus) add("cpus=" + FormatCpuList(*cpus));
+    if (addressSpace != 0) add("mem=" + FormatByteSize(addressSpace));
+    if (cpuSeconds != 0) add(std::format("cputime={}", cpuSeconds));
+    if (!cgroup.empty()) add("cgroup=" + cgroup);
+    return text;
+}
+
+bool ProcessLimits::ApplyToCurrentProcess() const {
+    // Join the cgroup first, so its own limits cover everything after
+    if (!cgroup.empty()) {
+        int dir = open(cgroup.c_str(), O_PATH | O_DIRECTORY | O_CLOEXEC);
+        int procs = dir >= 0 ? openat(dir, "cgroup.procs", O_WRONLY | O_CLOEXEC) : -1;
+        // "0" is the writing process
+        if (procs < 0 || write(procs, "0", 1) != 1) {
+            ReportFailure(cgroup.c_str(), errno);
+        }
+        if (procs >= 0) close(procs);
+        if (dir >= 0) close(dir);
+    }
+
+    if (nice != 0) {
+        errno = 0;
+        if (::nice(nice) == -1 && errno != 0) {
+            ReportFailure("nice", errno);
+            return false;
+        }
+    }
+    if (cpus && sched_setaffinity(0, sizeof(*cpus), &*cpus) != 0) {
+        ReportFailure("cpus", errno);
+        return false;
+    }
+    if (addressSpace != 0 && !LowerLimit(RLIMIT_AS, addressSpace, addressSpace)) {
+        ReportFailure("mem", errno);
+        return false;
+    }
+    // A second's grace between SIGXCPU and SIGKILL lets the program report it
+    if (cpuSeconds != 0 && !LowerLimit(RLIMIT_CPU, cpuSeconds, cpuSeconds + 1)) {
+        ReportFailure("cputime", errno);
+        return false;
+    }
+    return true;
+}
+
+bool ProcessLimits::ParseCpuList(std::string_view list, cpu_set_t& cpus) {
+    CPU_ZERO(&cpus);
+    if (list.empty()) return false;
+    while (!list.empty()) {
+        size_t comma = list.find(',');
+        std::string_view range = list.substr(0, comma);
+        list = comma == std::string_view::npos ? std::string_view() : list.substr(comma + 1);
+
+        size_t dash = range.find('-');
+        unsigned first = 0, last = 0;
+        if (!ParseNumber(range.substr(0, dash), first)) return false;
+        last = first;
+        if (dash != std::string_view::npos && !ParseNumber(range.substr(dash + 1), last)) return false;
+        if (last < first || last >= CPU_SETSIZE) return false;
+        for (unsigned cpu = first; cpu <= last; ++cpu) {
+            CPU_SET(cpu, &cpus);
+        }
+        if (comma != std::string_view::npos && list.empty()) return false;
+    }
+    return true;
+}
+
+std::string ProcessLimits::FormatCpuList(const cpu_set_t& cpus) {
+    std::string text;
+    for (int cpu = 0; cpu < CPU_SETSIZE; ++cpu) {
+        if (!CPU_ISSET(cpu, &cpus)) continue;
+        int last = cpu;
+        while (last + 1 < CPU_SETSIZE && CPU_ISSET(last + 1, &cpus)) ++last;
+        if (!text.empty()) text += ',';
+        text += last == cpu ? std::to_string(cpu) : std::format("{}-{}", cpu, last);
+        cpu = last;
+    }
+    return text;
+}
+
+bool SetThreadAffinity(const cpu_set_t& cpus) {
+    return pthread_setaffinity_np(pthread_self(), sizeof(cpus), &cpus) == 0;
+}
+
+} // namespace cll
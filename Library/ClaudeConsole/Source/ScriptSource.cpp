@@ -0,0 +1,166 @@
+#include "ScriptSource.h"
+#include <algorithm>
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+#include <format>
+#include "FdUtil.h"
+#include <sys/stat.h>
+
+namespace cll {
+
+namespace {
+
+constexpr uint64_t HighBits = 0x8080808080808080ull;
+
+// Whether the eight bytes at text[i] are all ASCII
+bool AsciiWord(std::string_view text, size_t i) {
+    uint64_t word;
+    std::memcpy(&word, text.data() + i, sizeof(word));
+    return (word & HighBits) == 0;
+}
+
+// Length and code point of the UTF-8 sequence at text[i], or 0 if it is
+// malformed: truncated, overlong, a surrogate or past U+10FFFF
+size_t DecodeOne(std::string_view text, size_t i, char32_t& codePoint) {
+    auto byte = [&](size_t at) { return static_cast<unsigned char>(text[at]); };
+    unsigned char lead = byte(i);
+    size_t length;
+    char32_t min;
+    if (lead < 0x80) {
+        codePoint = lead;
+        return 1;
+    } else if ((lead & 0xE0) == 0xC0) {
+        length = 2, min = 0x80, codePoint = lead & 0x1F;
+    } else if ((lead & 0xF0) == 0xE0) {
+        length = 3, min = 0x800, codePoint = lead & 0x0F;
+    } else if ((lead & 0xF8) == 0xF0) {
+        length = 4, min = 0x10000, codePoint = lead & 0x07;
+    } else {
+        return 0;
+    }
+    if (i + length > text.size()) return 0;
+    for (size_t k = 1; k < length; ++k) {
+        if ((byte(i + k) & 0xC0) != 0x80) return 0;
+        codePoint = (codePoint << 6) | (byte(i + k) & 0x3F);
+    }
+    if (codePoint < min || codePoint > 0x10FFFF || (codePoint >= 0xD800 && codePoint <= 0xDFFF)) {
+        return 0;
+    }
+    return length;
+}
+
+// Check text is UTF-8 and count the UTF-16 units it decodes to
+bool Measure(std::string_view text, size_t& units, char32_t& maxCodePoint) {
+    units = 0;
+    maxCodePoint = 0;
+    for (size_t i = 0; i < text.size();) {
+        // Runs of ASCII, the bulk of any script, a word at a time
+        if (i + 8 <= text.size() && AsciiWord(text, i)) {
+            units += 8;
+            maxCodePoint = std::max<char32_t>(maxCodePoint, 0x7F);
+            i += 8;
+            continue;
+        }
+        char32_t codePoint;
+        size_t length = DecodeOne(text, i, codePoint);
+        if (length == 0) return false;
+        units += codePoint > 0xFFFF ? 2 : 1;
+        maxCodePoint = std::max(maxCodePoint, codePoint);
+        i += length;
+    }
+    return true;
+}
+
+} // namespace
+
+bool ScriptSource::IsAsciiText(std::string_view text) {
+    // Eight bytes at a time: any high bit set means a non-ASCII byte
+    size_t i = 0;
+    for (; i + 8 <= text.size(); i += 8) {
+        if (!AsciiWord(text, i)) return false;
+    }
+    for (; i < text.size(); ++i) {
+        if (static_cast<unsigned char>(text[i]) & 0x80) return false;
+    }
+    return true;
+}
+
+ScriptSource::Encoding ScriptSource::Decode(std::string_view text, std::string& latin1, std::u16string& utf16) {
+    size_t units;
+    char32_t maxCodePoint;
+    if (!Measure(text, units, maxCodePoint)) {
+        return Encoding::Invalid;
+    }
+
+    // Sized up front and filled by index, so decoding never reallocates
+    bool narrow = maxCodePoint <= 0xFF;
+    if (narrow) {
+        latin1.resize(units);
+    } else {
+        utf16.resize(units);
+    }
+    size_t out = 0;
+    for (size_t i = 0; i < text.size();) {
+        if (i + 8 <= text.size() && AsciiWord(text, i)) {
+            for (size_t end = i + 8; i < end; ++i) {
+                if (narrow) {
+                    latin1[out++] = text[i];
+                } else {
+                    utf16[out++] = static_cast<char16_t>(static_cast<unsigned char>(text[i]));
+                }
+            }
+            continue;
+        }
+        char32_t codePoint;
+        i += DecodeOne(text, i, codePoint);
+        if (narrow) {
+            latin1[out++] = static_cast<char>(codePoint);
+        } else if (codePoint > 0xFFFF) {
+            codePoint -= 0x10000;
+            utf16[out++] = static_cast<char16_t>(0xD800 + (codePoint >> 10));
+            utf16[out++] = static_cast<char16_t>(0xDC00 + (codePoint & 0x3FF));
+        } else {
+            utf16[out++] = static_cast<char16_t>(codePoint);
+        }
+    }
+    return narrow ? Encoding::Latin1 : Encoding::Utf16;
+}
+
+std::shared_ptr<const ScriptSource> ScriptSource::Open(const std::string& path, std::string& error) {
+    FdGuard file(open(path.c_str(), O_RDONLY | O_CLOEXEC));
+    struct stat info;
+    if (file.fd < 0 || fstat(file.fd, &info) != 0) {
+        error = std::format("{}: {}", path, std::strerror(errno));
+        return nullptr;
+    }
+
+    // Read straight into a buffer of the file's size; a file that shrank
+    // meanwhile is taken as far as it goes
+    size_t capacity = static_cast<size_t>(info.st_size);
+    auto bytes = std::make_unique_for_overwrite<char[]>(capacity);
+    size_t size = 0;
+    while (size < capacity) {
+        ssize_t got = read(file.fd, bytes.get() + size, capacity - size);
+        if (got < 0 && errno == EINTR) continue;
+        if (got < 0) {
+            error = std::format("{}: {}", path, std::strerror(errno));
+            return nullptr;
+        }
+        if (got == 0) break;
+        size += static_cast<size_t>(got);
+    }
+    return FromBuffer(std::move(bytes), size);
+}
+
+std::shared_ptr<const ScriptSource> ScriptSource::FromBuffer(std::unique_ptr<char[]> bytes, size_t size) {
+    std::shared_ptr<ScriptSource> source(new ScriptSource());
+    source->bytes_ = std::move(bytes);
+    source->size_ = size;
+    source->ascii_ = IsAsciiText(source->Bytes());
+    source->encoding_ = source->ascii_ ? Encoding::Latin1
+                                       : Decode(source->Bytes(), source->latin1_, source->utf16_);
+    return source;
+}
+
+} // namespace cll
@@ -0,0 +1,138 @@
+#pragma once
+
+// Streaming compilation of script files for ExecuteFile and load()
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <cstring>
+#include <format>
+#include <memory>
+#include <string>
+#include <thread>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "FdUtil.h"
+#include "ScriptSource.h"
+#include "V8Compat.h"
+
+namespace cll {
+
+// Hands a file to V8's streaming parser in chunks, read by the thread that
+// runs the streaming task, so reading and parsing overlap. The file is read
+// once, into a buffer of its size: the compile that finishes on the
+// isolate's thread needs the whole text, and uses that buffer in place.
+class FileSourceStream : public v8::ScriptCompiler::ExternalSourceStream {
+public:
+    static constexpr size_t ChunkSize = 1 << 20;
+
+    FileSourceStream(int fd, char* buffer, size_t capacity, size_t& size)
+        : fd_(fd), buffer_(buffer), capacity_(capacity), size_(size) {}
+
+    size_t GetMoreData(const uint8_t** src) override {
+        size_t want = std::min(ChunkSize, capacity_ - size_);
+        ssize_t got = 0;
+        if (want > 0) {
+            do {
+                got = read(fd_, buffer_ + size_, want);
+            } while (got < 0 && errno == EINTR);
+        }
+        if (got <= 0) {
+            *src = nullptr;
+            return 0;
+        }
+        // V8 owns each chunk it is given and frees it with delete[] once
+        // parsed, so it gets a copy; the buffer keeps the text
+        auto* chunk = new uint8_t[static_cast<size_t>(got)];
+        std::memcpy(chunk, buffer_ + size_, static_cast<size_t>(got));
+        size_ += static_cast<size_t>(got);
+        *src = chunk;
+        return static_cast<size_t>(got);
+    }
+
+private:
+    int fd_;
+    char* buffer_;
+    size_t capacity_;
+    size_t& size_;
+};
+
+// One streamed compilation: Start() on the isolate's thread opens the file
+// and parses it on a thread of its own; back on the isolate's thread, Text()
+// waits for that and Finish() makes the script
+class StreamedScript {
+public:
+    StreamedScript(v8::Isolate* isolate, std::string path) : isolate_(isolate), path_(std::move(path)) {}
+
+    StreamedScript(const StreamedScript&) = delete;
+    StreamedScript& operator=(const StreamedScript&) = delete;
+
+    ~StreamedScript() {
+        if (worker_.joinable()) {
+            worker_.join();
+        }
+    }
+
+    bool Start(std::string& error) {
+        file_.Reset(open(path_.c_str(), O_RDONLY | O_CLOEXEC));
+        struct stat info;
+        if (file_.fd < 0 || fstat(file_.fd, &info) != 0) {
+            error = std::format("Error: Could not read file: \"{}\"", path_);
+            return false;
+        }
+        // A file that grows meanwhile is taken as far as its size here
+        capacity_ = static_cast<size_t>(info.st_size);
+        bytes_ = std::make_unique_for_overwrite<char[]>(capacity_);
+        source_ = std::make_unique<v8::ScriptCompiler::StreamedSource>(
+            std::make_unique<FileSourceStream>(file_.fd, bytes_.get(), capacity_, size_),
+            v8::ScriptCompiler::StreamedSource::UTF8);
+        task_.reset(v8_compat::StartStreaming(isolate_, source_.get()));
+        if (!task_) {
+            error = std::format("Error: Could not stream \"{}\"", path_);
+            return false;
+        }
+        worker_ = std::thread([this] {
+            task_->Run();
+            done_ = true;
+        });
+        return true;
+    }
+
+    // Whether Text() would return without waiting
+    bool Done() const { return done_; }
+
+    // Wait for the parse and take the text it read
+    std::shared_ptr<const ScriptSource> Text() {
+        if (worker_.joinable()) {
+            worker_.join();
+        }
+        if (!text_) {
+            file_.Reset();
+            text_ = ScriptSource::FromBuffer(std::move(bytes_), size_);
+        }
+        return text_;
+    }
+
+    // Make the script, given Text() as a string
+    v8::MaybeLocal<v8::Script> Finish(v8::Local<v8::Context> context, v8::Local<v8::String> text) {
+        v8::ScriptOrigin origin = v8_compat::CreateScriptOrigin(isolate_, path_);
+        return v8::ScriptCompiler::Compile(context, source_.get(), text, origin);
+    }
+
+    const std::string& Path() const { return path_; }
+
+private:
+    v8::Isolate* isolate_;
+    std::string path_;
+    FdGuard file_;
+    std::unique_ptr<char[]> bytes_;
+    size_t capacity_ = 0;
+    size_t size_ = 0;
+    std::shared_ptr<const ScriptSource> text_;
+    std::unique_ptr<v8::ScriptCompiler::StreamedSource> source_;
+    std::unique_ptr<v8::ScriptCompiler::ScriptStreamingTask> task_;
+    std::thread worker_;
+    std::atomic<bool> done_{false};
+};
+
+} // namespace cll
@@ -0,0 +1,240 @@
+#include "ShellSession.h"
+#include "FdUtil.h"
+#include "ChildInterrupter.h"
+#include "OutputReader.h"
+#include <cerrno>
+#include <cstdlib>
+#include <random>
+#include <string_view>
+#include <format>
+#include <poll.h>
+
+namespace cll {
+
+namespace {
+
+// Record separator; never produced by ordinary text output
+constexpr char MarkerByte = '\x1e';
+
+// A trapped signal interrupts the foreground command but not the shell;
+// unlike an ignored one, it is back to the default in the programs it runs
+constexpr std::string_view SessionSetup = "trap : INT TERM\n";
+
+// One of the session's output pipes, buffered until its sentinel shows up
+struct FramedStream {
+    int fd;
+    const ShellSession::ChunkCallback* sink;
+    std::string* capture;
+    std::string pending;
+    bool done = false;
+
+    FramedStream(int f, const ShellSession::ChunkCallback* s, std::string* c)
+        : fd(f), sink(s), capture(c) {}
+
+    void Deliver(size_t count) {
+        if (count == 0) return;
+        std::string_view chunk(pending.data(), count);
+        if (*sink) {
+            (*sink)(chunk);
+        } else {
+            capture->append(chunk);
+        }
+        pending.erase(0, count);
+    }
+
+    // Pass on everything that cannot be the start of a split sentinel
+    void DeliverSafePrefix(size_t markerSize) {
+        size_t keepFrom = pending.size();
+        size_t tailStart = pending.size() > markerSize ? pending.size() - markerSize : 0;
+        size_t pos = pending.find(MarkerByte, tailStart);
+        if (pos != std::string::npos) {
+            keepFrom = pos;
+        }
+        Deliver(keepFrom);
+    }
+};
+
+} // namespace
+
+ShellSession::ShellSession(ProcessExecutor& executor)
+    : executor_(executor) {
+}
+
+ShellSession::~ShellSession() {
+    Stop();
+}
+
+std::string ShellSession::QuoteWord(const std::string& text) {
+    std::string quoted = "'";
+    for (char c : text) {
+        if (c == '\'') {
+            quoted += "'\\''";
+        } else {
+            quoted += c;
+        }
+    }
+    quoted += "'";
+    return quoted;
+}
+
+bool ShellSession::Start(std::string& error) {
+    if (IsRunning()) return true;
+
+    ProcessRequest request;
+    request.argv = {"/bin/sh"};
+    request.pipeStdin = true;
+    request.newProcessGroup = true;
+    request.limits = limits_;
+    if (!executor_.Spawn(request, child_, error)) {
+        child_ = ChildProcess{};
+        return false;
+    }
+    SetNonBlocking(child_.stdoutFd);
+    SetNonBlocking(child_.stderrFd);
+    if (!WriteAll(child_.stdinFd, SessionSetup.data(), SessionSetup.size())) {
+        error = "Could not set up the shell session";
+        Stop();
+        return false;
+    }
+
+    // A fresh nonce per session keeps command output from forging a sentinel
+    std::random_device random;
+    std::string nonce = std::format("cll{:08x}{:08x}", random(), random());
+    marker_ = MarkerByte + nonce + MarkerByte;
+    markerEscaped_ = "\\036" + nonce + "\\036";
+    return true;
+}
+
+void ShellSession::Stop() {
+    if (!IsRunning()) return;
+
+    // EOF on stdin makes the shell exit on its own
+    close(child_.stdinFd);
+    close(child_.stdoutFd);
+    close(child_.stderrFd);
+    executor_.Wait(child_);
+    child_ = ChildProcess{};
+}
+
+CommandResult ShellSession::Execute(const std::string& command, const ChunkCallback& onStdout,
+                                    const ChunkCallback& onStderr) {
+    auto startTime = std::chrono::high_resolution_clock::now();
+
+    std::string error;
+    if (!Start(error)) {
+        return {false, "", error, std::chrono::microseconds(0), 127};
+    }
+
+    // "command eval" keeps syntax errors from terminating the shell; the two
+    // printf lines frame the output and report eval's exit status
+    std::string script = "command eval " + QuoteWord(command) + " </dev/null\n" +
+        "printf '" + markerEscaped_ + "%d\\n' \"$?\"\n" +
+        "printf '" + markerEscaped_ + "\\n' >&2\n";
+
+    CommandResult result;
+    result.exitCode = 0;
+
+    FramedStream streams[2] = {
+        {child_.stdoutFd, &onStdout, &result.output},
+        {child_.stderrFd, &onStderr, &result.error}
+    };
+    PooledReadBuffer buffer;
+    bool shellExited = !WriteAll(child_.stdinFd, script.data(), script.size());
+    ChildInterrupter interrupter(-child_.pid, timeout_, cancel_);
+
+    while (!shellExited && (!streams[0].done || !streams[1].done)) {
+        pollfd fds[3];
+        FramedStream* polled[2];
+        nfds_t count = 0;
+        for (auto& stream : streams) {
+            if (!stream.done) {
+                fds[count] = {stream.fd, POLLIN, 0};
+                polled[count++] = &stream;
+            }
+        }
+        nfds_t streamCount = count;
+        if (interrupter.CancelFd() >= 0) {
+            fds[count++] = {interrupter.CancelFd(), POLLIN, 0};
+        }
+
+        if (poll(fds, count, interrupter.PollTimeout()) < 0) {
+            if (errno == EINTR) continue;
+            shellExited = true;
+            break;
+        }
+        if (!interrupter.Update()) {
+            shellExited = true;
+            break;
+        }
+
+        for (nfds_t i = 0; i < streamCount; ++i) {
+            if (!(fds[i].revents & (POLLIN | POLLHUP | POLLERR))) continue;
+            FramedStream& stream = *polled[i];
+
+            while (!stream.done) {
+                ssize_t n = read(stream.fd, buffer.Data(), buffer.Size());
+                if (n < 0 && errno == EINTR) continue;
+                if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) break;
+                if (n <= 0) {
+                    // The shell went away (exit, exec or a crash)
+                    stream.Deliver(stream.pending.size());
+                    stream.done = true;
+                    shellExited = true;
+                    break;
+                }
+                stream.pending.append(buffer.Data(), static_cast<size_t>(n));
+
+                size_t pos = stream.pending.find(marker_);
+                if (pos == std::string::npos) {
+                    stream.DeliverSafePrefix(marker_.size());
+                    continue;
+                }
+
+                // The status line ends with a newline that may not be here yet
+                size_t lineEnd = stream.pending.find('\n', pos + marker_.size());
+                if (lineEnd == std::string::npos) {
+                    stream.Deliver(pos);
+                    continue;
+                }
+                if (&stream == &streams[0]) {
+                    result.exitCode = std::atoi(stream.pending.c_str() + pos + marker_.size());
+                }
+                stream.Deliver(pos);
+                stream.pending.clear();
+                stream.done = true;
+            }
+        }
+    }
+
+    if (shellExited) {
+        // Collect whatever else was written up to EOF, then reap the shell
+        for (auto& stream : streams) {
+            fcntl(stream.fd, F_SETFL, fcntl(stream.fd, F_GETFL) & ~O_NONBLOCK);
+            ssize_t n;
+            while ((n = read(stream.fd, buffer.Data(), buffer.Size())) > 0) {
+                stream.pending.append(buffer.Data(), static_cast<size_t>(n));
+            }
+            stream.Deliver(stream.pending.size());
+        }
+        close(child_.stdinFd);
+        close(child_.stdoutFd);
+        close(child_.stderrFd);
+        result.exitCode = executor_.Wait(child_);
+        child_ = ChildProcess{};
+        if (interrupter.Interrupted()) {
+            if (!result.error.empty() && result.error.back() != '\n') {
+                result.error += '\n';
+            }
+            result.error += "Shell session restarted, state lost";
+        }
+    }
+
+    result.timedOut = interrupter.TimedOut();
+    result.cancelled = interrupter.Cancelled();
+    result.success = (result.exitCode == 0) && !interrupter.Interrupted();
+    result.executionTime = std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::high_resolution_clock::now() - startTime);
+    return result;
+}
+
+} // namespace cll
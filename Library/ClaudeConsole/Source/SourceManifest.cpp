@@ -0,0 +1,92 @@
+#include "SourceManifest.h"
+#include <charconv>
+#include <filesystem>
+#include <format>
+#include <fstream>
+#include <istream>
+#include <ostream>
+
+namespace cll {
+
+namespace fs = std::filesystem;
+
+bool SourceManifest::Add(const std::string& path) {
+    std::error_code ec;
+    fs::path absolute = fs::absolute(path, ec);
+    std::string name = ec ? path : absolute.lexically_normal().string();
+    auto hash = HashFile(name);
+    if (!hash) {
+        return false;
+    }
+    for (const Entry& entry : entries_) {
+        if (entry.path == name) return true;
+    }
+    entries_.push_back({name, *hash});
+    return true;
+}
+
+bool SourceManifest::IsCurrent() const {
+    for (const Entry& entry : entries_) {
+        if (HashFile(entry.path) != entry.hash) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// key
+// <count>
+// <16 hex digits> <path>   (count lines)
+void SourceManifest::Write(std::ostream& out, std::string_view key) const {
+    out << key << '\n' << entries_.size() << '\n';
+    for (const Entry& entry : entries_) {
+        out << std::format("{:016x} {}\n", entry.hash, entry.path);
+    }
+}
+
+bool SourceManifest::Read(std::istream& in, std::string_view key) {
+    entries_.clear();
+    std::string line;
+    if (!std::getline(in, line) || line != key || !std::getline(in, line)) {
+        return false;
+    }
+    size_t count = 0;
+    auto [end, ec] = std::from_chars(line.data(), line.data() + line.size(), count);
+    if (ec != std::errc() || end != line.data() + line.size()) {
+        return false;
+    }
+    for (size_t i = 0; i < count; ++i) {
+        if (!std::getline(in, line) || line.size() < 18 || line[16] != ' ') {
+            entries_.clear();
+            return false;
+        }
+        uint64_t hash = 0;
+        auto [hashEnd, hashEc] = std::from_chars(line.data(), line.data() + 16, hash, 16);
+        if (hashEc != std::errc() || hashEnd != line.data() + 16) {
+            entries_.clear();
+            return false;
+        }
+        entries_.push_back({line.substr(17), hash});
+    }
+    return true;
+}
+
+uint64_t SourceManifest::Hash(std::string_view data) {
+    uint64_t hash = 0xcbf29ce484222325ull;
+    for (unsigned char byte : data) {
+        hash ^= byte;
+        hash *= 0x100000001b3ull;
+    }
+    return hash;
+}
+
+std::optional<uint64_t> SourceManifest::HashFile(const std::string& path) {
+    std::ifstream file(path, std::ios::binary);
+    if (!file) {
+        return std::nullopt;
+    }
+    std::string data(std::istreambuf_iterator<char>(file), {});
+    return Hash(data);
+}
+
+} // namespace cll
@@ -0,0 +1,408 @@
+#include "SpawnServer.h"
+#include "FdUtil.h"
+#include <cerrno>
+#include <csignal>
+#include <cstring>
+#include <vector>
+#include <poll.h>
+#include <sys/prctl.h>
+#include <sys/signalfd.h>
+#include <sys/socket.h>
+#include <sys/wait.h>
+
+extern char** environ;
+
+namespace cll {
+
+namespace {
+
+enum class ReplyType : uint32_t {
+    Spawned,
+    Exited
+};
+
+// Fixed part of a spawn request; cwd, cgroup, program, argv and the
+// environment follow as NUL-terminated strings, and stdin/stdout/stderr
+// ride along as SCM_RIGHTS
+struct RequestHeader {
+    uint32_t id;
+    uint32_t flags;
+    uint32_t argc;
+    uint32_t envc;
+    pid_t processGroup;
+    int32_t nice;
+    uint64_t addressSpace;
+    uint64_t cpuSeconds;
+    cpu_set_t cpus;     // with CpusFlag
+};
+
+constexpr size_t MaxRequestSize = 128 * 1024;
+constexpr int PassedFdCount = 3;
+constexpr uint32_t NewProcessGroupFlag = 1;
+constexpr uint32_t CpusFlag = 2;
+
+void AppendString(std::string& out, const std::string& text) {
+    out.append(text);
+    out.push_back('\0');
+}
+
+} // namespace
+
+struct SpawnServer::Reply {
+    ReplyType type;
+    uint32_t id;
+    pid_t pid;
+    int value;      // errno for Spawned, wait status for Exited
+    rusage usage;   // Exited only
+};
+
+SpawnServer::~SpawnServer() {
+    Stop();
+}
+
+bool SpawnServer::IsRunning() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return alive_;
+}
+
+bool SpawnServer::Start() {
+    if (IsRunning()) return true;
+
+    int fds[2];
+    if (socketpair(AF_UNIX, SOCK_SEQPACKET | SOCK_CLOEXEC, 0, fds) != 0) {
+        return false;
+    }
+
+    pid_t pid = fork();
+    if (pid < 0) {
+        close(fds[0]);
+        close(fds[1]);
+        return false;
+    }
+
+    if (pid == 0) {
+        close(fds[0]);
+        ServerLoop(fds[1]);
+        _exit(0);
+    }
+
+    close(fds[1]);
+    socket_ = fds[0];
+    serverPid_ = pid;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        alive_ = true;
+    }
+    reader_ = std::thread(&SpawnServer::ReaderLoop, this);
+    return true;
+}
+
+void SpawnServer::Stop() {
+    if (socket_ < 0) return;
+
+    // Closing our end tells the helper to exit and wakes the reader
+    shutdown(socket_, SHUT_RDWR);
+    if (reader_.joinable()) {
+        reader_.join();
+    }
+    close(socket_);
+    socket_ = -1;
+
+    while (waitpid(serverPid_, nullptr, 0) < 0 && errno == EINTR) {
+    }
+    serverPid_ = -1;
+}
+
+void SpawnServer::ReaderLoop() {
+    while (true) {
+        Reply reply;
+        ssize_t n = recv(socket_, &reply, sizeof(reply), 0);
+        if (n < 0 && errno == EINTR) continue;
+        if (n != sizeof(reply)) break;
+
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (reply.type == ReplyType::Spawned) {
+            spawnReplies_[reply.id] = {reply.pid, reply.value};
+        } else {
+            exitStatuses_[reply.pid] = {reply.value, reply.usage};
+        }
+        changed_.notify_all();
+    }
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    alive_ = false;
+    changed_.notify_all();
+}
+
+bool SpawnServer::Spawn(const ProcessRequest& request, ChildProcess& child, std::string& error) {
+    if (request.argv.empty()) {
+        error = "Failed to execute command: empty command";
+        return false;
+    }
+
+    // Send the console's current directory and environment, which may have
+    // changed since the helper was forked
+    RequestHeader header{};
+    size_t envc = 0;
+    while (environ[envc]) ++envc;
+    header.flags = request.newProcessGroup ? NewProcessGroupFlag : 0;
+    header.processGroup = request.processGroup;
+    const ProcessLimits& limits = request.limits;
+    header.nice = limits.nice;
+    header.addressSpace = limits.addressSpace;
+    header.cpuSeconds = limits.cpuSeconds;
+    if (limits.cpus) {
+        header.flags |= CpusFlag;
+        header.cpus = *limits.cpus;
+    }
+    header.argc = static_cast<uint32_t>(request.argv.size());
+    header.envc = static_cast<uint32_t>(envc);
+
+    std::string payload(sizeof(header), '\0');
+    char cwd[4096];
+    AppendString(payload, getcwd(cwd, sizeof(cwd)) ? cwd : ".");
+    AppendString(payload, limits.cgroup);
+    AppendString(payload, request.program);
+    for (const auto& arg : request.argv) {
+        AppendString(payload, arg);
+    }
+    for (size_t i = 0; i < envc; ++i) {
+        AppendString(payload, environ[i]);
+    }
+    if (payload.size() > MaxRequestSize) {
+        error = "Spawn request too large";
+        return false;
+    }
+
+    FdGuard inRead, inWrite, outRead, outWrite, errRead, errWrite;
+    bool pipeIn = request.stdinFd < 0 && request.pipeStdin;
+    bool pipeOut = request.stdoutFd < 0;
+    bool pipeErr = request.stderrFd < 0 && !request.mergeStderr;
+    if ((pipeIn && !MakePipe(inRead, inWrite)) ||
+        (pipeOut && !MakePipe(outRead, outWrite)) ||
+        (pipeErr && !MakePipe(errRead, errWrite))) {
+        error = std::string("Failed to create pipe: ") + std::strerror(errno);
+        return false;
+    }
+
+    int stdoutFd = pipeOut ? outWrite.fd : request.stdoutFd;
+    int passed[PassedFdCount] = {
+        request.stdinFd >= 0 ? request.stdinFd : pipeIn ? inRead.fd : STDIN_FILENO,
+        stdoutFd,
+        request.stderrFd >= 0 ? request.stderrFd : request.mergeStderr ? stdoutFd : errWrite.fd
+    };
+
+    std::unique_lock<std::mutex> lock(mutex_);
+    if (!alive_) {
+        error = "Spawn server is not running";
+        return false;
+    }
+    header.id = nextRequestId_++;
+    std::memcpy(payload.data(), &header, sizeof(header));
+
+    iovec iov{payload.data(), payload.size()};
+    alignas(cmsghdr) char control[CMSG_SPACE(sizeof(passed))] = {};
+    msghdr message{};
+    message.msg_iov = &iov;
+    message.msg_iovlen = 1;
+    message.msg_control = control;
+    message.msg_controllen = sizeof(control);
+    cmsghdr* cmsg = CMSG_FIRSTHDR(&message);
+    cmsg->cmsg_level = SOL_SOCKET;
+    cmsg->cmsg_type = SCM_RIGHTS;
+    cmsg->cmsg_len = CMSG_LEN(sizeof(passed));
+    std::memcpy(CMSG_DATA(cmsg), passed, sizeof(passed));
+
+    ssize_t sent;
+    while ((sent = sendmsg(socket_, &message, MSG_NOSIGNAL)) < 0 && errno == EINTR) {
+    }
+    if (sent < 0) {
+        error = std::string("Spawn server request failed: ") + std::strerror(errno);
+        return false;
+    }
+
+    uint32_t id = header.id;
+    changed_.wait(lock, [&] { return !alive_ || spawnReplies_.count(id) > 0; });
+    auto it = spawnReplies_.find(id);
+    if (it == spawnReplies_.end()) {
+        error = "Spawn server exited";
+        return false;
+    }
+    auto [pid, err] = it->second;
+    spawnReplies_.erase(it);
+    lock.unlock();
+
+    if (pid < 0) {
+        error = "Failed to execute " + request.argv[0] + ": " + std::strerror(err);
+        return false;
+    }
+
+    child.pid = pid;
+    child.stdinFd = inWrite.Release();
+    child.stdoutFd = outRead.Release();
+    child.stderrFd = errRead.Release();
+    child.viaServer = true;
+    return true;
+}
+
+int SpawnServer::Wait(pid_t pid, rusage* usage) {
+    std::unique_lock<std::mutex> lock(mutex_);
+    changed_.wait(lock, [&] { return !alive_ || exitStatuses_.count(pid) > 0; });
+
+    auto it = exitStatuses_.find(pid);
+    if (it == exitStatuses_.end()) {
+        // The helper died and took the child's status with it
+        return W_EXITCODE(1, 0);
+    }
+    int status = it->second.status;
+    if (usage) {
+        *usage = it->second.usage;
+    }
+    exitStatuses_.erase(it);
+    return status;
+}
+
+// Everything below runs in the forked helper process
+void SpawnServer::ServerLoop(int socket) {
+    // Die with the console, and leave terminal signals to the children
+    prctl(PR_SET_PDEATHSIG, SIGKILL);
+
+    // Children get the console's SIGTSTP disposition, as with posix_spawn;
+    // the REPL ignores it, and so do they
+    struct sigaction consoleTstp;
+    sigaction(SIGTSTP, nullptr, &consoleTstp);
+    signal(SIGINT, SIG_IGN);
+    signal(SIGQUIT, SIG_IGN);
+    signal(SIGTSTP, SIG_IGN);
+
+    sigset_t childSet, oldSet;
+    sigemptyset(&childSet);
+    sigaddset(&childSet, SIGCHLD);
+    sigprocmask(SIG_BLOCK, &childSet, &oldSet);
+    int childFd = signalfd(-1, &childSet, SFD_CLOEXEC | SFD_NONBLOCK);
+
+    std::vector<char> buffer(MaxRequestSize);
+    while (true) {
+        pollfd fds[2] = {{socket, POLLIN, 0}, {childFd, POLLIN, 0}};
+        if (poll(fds, 2, -1) < 0) {
+            if (errno == EINTR) continue;
+            break;
+        }
+
+        if (fds[1].revents & POLLIN) {
+            signalfd_siginfo info;
+            while (read(childFd, &info, sizeof(info)) > 0) {
+            }
+            int status;
+            rusage usage;
+            pid_t pid;
+            while ((pid = wait4(-1, &status, WNOHANG, &usage)) > 0) {
+                Reply reply{ReplyType::Exited, 0, pid, status, usage};
+                send(socket, &reply, sizeof(reply), MSG_NOSIGNAL);
+            }
+        }
+
+        if (!(fds[0].revents & (POLLIN | POLLHUP | POLLERR))) continue;
+
+        alignas(cmsghdr) char control[CMSG_SPACE(sizeof(int) * PassedFdCount)];
+        iovec iov{buffer.data(), buffer.size()};
+        msghdr message{};
+        message.msg_iov = &iov;
+        message.msg_iovlen = 1;
+        message.msg_control = control;
+        message.msg_controllen = sizeof(control);
+
+        ssize_t n = recvmsg(socket, &message, MSG_CMSG_CLOEXEC);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) break;
+
+        int passed[PassedFdCount] = {-1, -1, -1};
+        cmsghdr* cmsg = CMSG_FIRSTHDR(&message);
+        if (cmsg && cmsg->cmsg_type == SCM_RIGHTS) {
+            std::memcpy(passed, CMSG_DATA(cmsg), sizeof(passed));
+        }
+        if (static_cast<size_t>(n) < sizeof(RequestHeader)) continue;
+
+        RequestHeader header;
+        std::memcpy(&header, buffer.data(), sizeof(header));
+
+        // Unpack cwd, cgroup, program, argv and env in place; the strings stay in buffer
+        std::vector<char*> strings;
+        char* cursor = buffer.data() + sizeof(header);
+        char* end = buffer.data() + n;
+        while (cursor < end) {
+            strings.push_back(cursor);
+            cursor += std::strlen(cursor) + 1;
+        }
+
+        Reply reply{ReplyType::Spawned, header.id, -1, EINVAL, {}};
+        if (strings.size() == 3 + header.argc + header.envc && header.argc > 0) {
+            const char* program = strings[2];
+            std::vector<char*> argv(strings.begin() + 3, strings.begin() + 3 + header.argc);
+            argv.push_back(nullptr);
+            std::vector<char*> envp(strings.begin() + 3 + header.argc, strings.end());
+            envp.push_back(nullptr);
+
+            ProcessLimits limits;
+            limits.nice = header.nice;
+            limits.addressSpace = header.addressSpace;
+            limits.cpuSeconds = header.cpuSeconds;
+            if (header.flags & CpusFlag) limits.cpus = header.cpus;
+            limits.cgroup = strings[1];
+
+            pid_t pid = fork();
+            if (pid == 0) {
+                sigprocmask(SIG_SETMASK, &oldSet, nullptr);
+                signal(SIGINT, SIG_DFL);
+                signal(SIGQUIT, SIG_DFL);
+                sigaction(SIGTSTP, &consoleTstp, nullptr);
+                if (header.flags & NewProcessGroupFlag) {
+                    setpgid(0, 0);
+                } else if (header.processGroup > 0) {
+                    setpgid(0, header.processGroup);
+                }
+
+                dup2(passed[0], STDIN_FILENO);
+                dup2(passed[1], STDOUT_FILENO);
+                dup2(passed[2], STDERR_FILENO);
+                if (!limits.ApplyToCurrentProcess()) {
+                    _exit(127);
+                }
+                // If the directory is gone, run in the helper's rather than not at all
+                (void)!chdir(strings[0]);
+                environ = envp.data();
+                if (*program) {
+                    execv(program, argv.data());
+                    if (errno == ENOEXEC) {
+                        // No #! line: the shell runs it, as execvp would
+                        std::vector<char*> shellArgv = {const_cast<char*>("sh"), const_cast<char*>(program)};
+                        shellArgv.insert(shellArgv.end(), argv.begin() + 1, argv.end());
+                        execv("/bin/sh", shellArgv.data());
+                    }
+                } else {
+                    execvp(argv[0], argv.data());
+                }
+
+                std::string message = std::string("cll: ") + argv[0] + ": " + std::strerror(errno) + "\n";
+                ssize_t ignored = write(STDERR_FILENO, message.data(), message.size());
+                (void)ignored;
+                _exit(127);
+            }
+            if (pid > 0 && (header.flags & NewProcessGroupFlag)) {
+                // Also set it here so the group exists before the reply goes out
+                setpgid(pid, pid);
+            } else if (pid > 0 && header.processGroup > 0) {
+                setpgid(pid, header.processGroup);
+            }
+            reply.pid = pid;
+            reply.value = pid < 0 ? errno : 0;
+        }
+
+        for (int fd : passed) {
+            if (fd >= 0) close(fd);
+        }
+        send(socket, &reply, sizeof(reply), MSG_NOSIGNAL);
+    }
+}
+
+} // namespace cll
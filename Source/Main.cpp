@@ -5,6 +5,7 @@
 #include <filesystem>
 #include <fstream>
 #include <cstdlib>
+#include <csignal>
 
 #ifndef NO_READLINE
 #include <readline/readline.h>
@@ -129,28 +130,56 @@ using namespace cll;
 
 class ConsoleUI {
 public:
-    ConsoleUI() : console_(std::make_unique<ClaudeConsole>()), shouldExit_(false) {
+    ConsoleUI() : console_(std::make_unique<ClaudeConsole>()), shouldExit_(false), lastOutputChar_('\n') {
         console_->SetOutputCallback([this](const std::string& text) {
-            std::cout << text;
+            LeavePrompt();
+            std::cout << text << std::flush;
+            if (!text.empty()) lastOutputChar_ = text.back();
         });
         console_->SetErrorCallback([this](const std::string& text) {
+            LeavePrompt();
             std::cerr << "\033[31m" << text << "\033[0m"; // Red color for errors
         });
+        
+        // Show shell output as it arrives instead of after the command exits
+        console_->SetStreamingOutput(true);
     }
     
     bool Initialize() {
+        // Before the console forks its spawn server, which copies these
+        InstallSignalHandlers();
         return console_->Initialize();
     }
     
+    void SetPersistentShell(bool enabled) {
+        console_->SetPersistentShell(enabled);
+    }
+    
     void Run() {
         PrintWelcome();
         
         std::string input;
+        bool firstPrompt = true;
         while (!shouldExit_) {
+            ReportFinishedJobs();
+            // Scripts from load(path, {background: true}) that are compiled
+            console_->RunFinishedLoads();
+            // V8 tasks posted while a shell command ran
+            console_->PumpMessageLoop();
             std::string prompt = GetPrompt();
             
+            // V8 is set up on first use; with javascript_warm_up, or when
+            // starting in JavaScript mode, it warms up while the first
+            // prompt waits for input
+            if (firstPrompt && (console_->GetJavaScriptWarmUp() || console_->IsJavaScriptMode())) {
+                console_->WarmUpJavaScript();
+            }
+            firstPrompt = false;
+            
 #ifndef NO_READLINE
+            atPrompt_ = true;
             char* line = readline(prompt.c_str());
+            atPrompt_ = false;
             if (!line) {
                 // EOF (Ctrl+D)
                 if (console_->IsInMultiLineMode()) {
@@ -210,6 +239,66 @@ public:
     }
     
 private:
+    // Ctrl-C interrupts the running command instead of killing the REPL.
+    // Ctrl-Z is ignored, and commands inherit that on purpose: nothing here
+    // would notice a stopped foreground command, take the terminal back or
+    // resume it, so stopping one would hang the prompt
+    void InstallSignalHandlers() {
+        activeConsole_ = console_.get();
+        activeUI_ = this;
+#ifndef NO_READLINE
+        rl_event_hook = OnReadlineIdle;
+#endif
+        
+        struct sigaction action {};
+        action.sa_handler = OnInterrupt;
+        sigemptyset(&action.sa_mask);
+        sigaction(SIGINT, &action, nullptr);
+        signal(SIGTSTP, SIG_IGN);
+    }
+    
+    static void OnInterrupt(int) {
+        if (activeConsole_) activeConsole_->RequestCancel();
+    }
+    
+#ifndef NO_READLINE
+    // Readline calls this every keyboard timeout (a tenth of a second)
+    // while it waits, so V8's foreground and idle-time work is done
+    // between keystrokes instead of during the next command
+    static int OnReadlineIdle() {
+        ConsoleUI* ui = activeUI_;
+        if (!ui) return 0;
+        // Readline only acts on a signal back in its input loop, which a
+        // runaway task never returns to, so take Ctrl-C directly meanwhile
+        struct sigaction action {}, readlineAction;
+        action.sa_handler = OnInterrupt;
+        sigemptyset(&action.sa_mask);
+        sigaction(SIGINT, &action, &readlineAction);
+        ui->console_->PumpMessageLoop();
+        ui->console_->RunIdleTasks();
+        sigaction(SIGINT, &readlineAction, nullptr);
+        if (ui->promptInterrupted_) {
+            // A task printed: put the prompt and what was typed back under it
+            if (ui->lastOutputChar_ != '\n') std::cout << '\n';
+            std::cout << std::flush;
+            ui->lastOutputChar_ = '\n';
+            ui->promptInterrupted_ = false;
+            ui->atPrompt_ = true;
+            rl_on_new_line();
+            rl_redisplay();
+        }
+        return 0;
+    }
+#endif
+    
+    // Output from a task run while readline waits clears the prompt line first
+    void LeavePrompt() {
+        if (!atPrompt_) return;
+        atPrompt_ = false;
+        promptInterrupted_ = true;
+        std::cout << "\r\033[K" << std::flush;
+    }
+    
     void PrintWelcome() {
         // No banner - start clean
     }
@@ -230,14 +319,31 @@ private:
     }
     
     void ProcessCommand(const std::string& input) {
+        lastOutputChar_ = '\n';
         auto result = console_->ExecuteCommand(input);
+        
+        // Keep the prompt on its own line after streamed output
+        if (lastOutputChar_ != '\n') {
+            std::cout << '\n';
+        }
         ProcessResult(result);
     }
     
+    void ReportFinishedJobs() {
+        for (const auto& report : console_->TakeFinishedJobs()) {
+            std::cout << "\033[90m" << ClaudeConsole::FormatJobReport(report) << "\033[0m";
+        }
+    }
+    
     void ProcessResult(const CommandResult& result) {
-        if (!result.output.empty()) {
-            std::cout << result.output;
-            if (result.output.back() != '\n') {
+        std::string_view output = result.OutputView();
+        if (!output.empty()) {
+            if (result.spilledOutput) {
+                result.spilledOutput->WriteTo(std::cout);
+            } else {
+                std::cout << output;
+            }
+            if (output.back() != '\n') {
                 std::cout << '\n';
             }
         }
@@ -248,17 +354,27 @@ private:
         
         // Show execution time for non-trivial commands
         if (result.executionTime.count() > 1000) { // > 1ms
-            std::cout << "\033[90m(" << ClaudeConsole::FormatExecutionTime(result.executionTime) << ")\033[0m\n";
+            std::cout << "\033[90m(" << ClaudeConsole::FormatExecutionTime(result) << ")\033[0m\n";
         }
     }
     
     std::unique_ptr<ClaudeConsole> console_;
     bool shouldExit_;
+    char lastOutputChar_;
+    bool atPrompt_ = false;
+    bool promptInterrupted_ = false;
+    
+    static ClaudeConsole* activeConsole_;
+    static ConsoleUI* activeUI_;
 };
 
+ClaudeConsole* ConsoleUI::activeConsole_ = nullptr;
+ConsoleUI* ConsoleUI::activeUI_ = nullptr;
+
 
 int main(int argc, char* argv[]) {
     // Handle command line arguments
+    bool persistentShell = false;
     if (argc > 1) {
         std::string arg = argv[1];
         if (arg == "--help" || arg == "-h") {
@@ -267,6 +383,7 @@ int main(int argc, char* argv[]) {
             std::cout << "  --help, -h      Show this help message\n";
             std::cout << "  --configure     Run the interactive prompt configuration wizard\n";
             std::cout << "  --version, -v   Show version information\n";
+            std::cout << "  --persistent-shell  Keep one shell process so cd/export persist\n";
             return 0;
         } else if (arg == "--configure") {
             SharedConfig::RunPromptWizard();
@@ -274,10 +391,13 @@ int main(int argc, char* argv[]) {
         } else if (arg == "--version" || arg == "-v") {
             std::cout << "cll (Claude Command Line) version 1.0.0\n";
             return 0;
+        } else if (arg == "--persistent-shell") {
+            persistentShell = true;
         }
     }
     
     ConsoleUI ui;
+    ui.SetPersistentShell(persistentShell);
     
     if (!ui.Initialize()) {
         std::cerr << "Failed to initialize console\n";
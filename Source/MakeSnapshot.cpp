@@ -0,0 +1,20 @@
+// Build step: writes the V8 startup snapshot cll deserializes at its first
+// JavaScript, with the global object and builtins already set up
+#include "ClaudeConsole.h"
+#include <iostream>
+
+int main(int argc, char* argv[]) {
+    if (argc != 2) {
+        std::cerr << "Usage: " << argv[0] << " <snapshot file>\n";
+        return 2;
+    }
+
+    // No console: its constructor would set up the config directory of
+    // whoever runs the build
+    std::string error;
+    if (!cll::ClaudeConsole::WriteStartupSnapshot(argv[1], error)) {
+        std::cerr << "cll_snapshot: " << error << "\n";
+        return 1;
+    }
+    return 0;
+}
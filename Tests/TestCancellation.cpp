@@ -0,0 +1,152 @@
+#include <gtest/gtest.h>
+#include "ClaudeConsole.h"
+#include "ProcessExecutor.h"
+#include "ShellSession.h"
+#include <thread>
+
+using namespace cll;
+using namespace std::chrono_literals;
+
+class CancellationTest : public ::testing::Test {
+protected:
+    // Cancel the token after a delay, from another thread
+    std::thread CancelLater(CancelToken& token, std::chrono::milliseconds delay) {
+        return std::thread([&token, delay] {
+            std::this_thread::sleep_for(delay);
+            token.Cancel();
+        });
+    }
+
+    ProcessExecutor executor;
+};
+
+// Test the token state and reset
+TEST_F(CancellationTest, TokenResets) {
+    CancelToken token;
+    EXPECT_FALSE(token.IsCancelled());
+    token.Cancel();
+    EXPECT_TRUE(token.IsCancelled());
+    token.Reset();
+    EXPECT_FALSE(token.IsCancelled());
+}
+
+// Test a timeout stops the whole process group
+TEST_F(CancellationTest, TimeoutKillsProcessGroup) {
+    auto request = ProcessRequest::Shell("echo started; sleep 30 & wait");
+    request.newProcessGroup = true;
+    request.timeout = 200ms;
+
+    auto start = std::chrono::steady_clock::now();
+    auto result = executor.Execute(request);
+    EXPECT_LT(std::chrono::steady_clock::now() - start, 5s);
+    EXPECT_TRUE(result.timedOut);
+    EXPECT_FALSE(result.cancelled);
+    EXPECT_FALSE(result.success);
+    EXPECT_EQ(result.exitCode, 128 + SIGTERM);
+    EXPECT_EQ(result.output, "started\n");
+}
+
+// Test commands that ignore SIGTERM are killed after the grace period
+TEST_F(CancellationTest, TimeoutEscalatesToKill) {
+    auto request = ProcessRequest::Shell("trap '' TERM; sleep 30");
+    request.newProcessGroup = true;
+    request.timeout = 100ms;
+
+    auto result = executor.Execute(request);
+    EXPECT_TRUE(result.timedOut);
+    EXPECT_EQ(result.exitCode, 128 + SIGKILL);
+}
+
+// Test cancellation sends SIGINT and is reported distinctly
+TEST_F(CancellationTest, CancelInterruptsCommand) {
+    CancelToken token;
+    auto request = ProcessRequest::Shell("sleep 30");
+    request.newProcessGroup = true;
+    request.cancel = &token;
+
+    auto canceller = CancelLater(token, 100ms);
+    auto result = executor.Execute(request);
+    canceller.join();
+    EXPECT_TRUE(result.cancelled);
+    EXPECT_FALSE(result.timedOut);
+    EXPECT_EQ(result.exitCode, 128 + SIGINT);
+}
+
+// Test quick commands are unaffected by a timeout
+TEST_F(CancellationTest, FastCommandWithinTimeout) {
+    auto request = ProcessRequest::Shell("echo quick");
+    request.timeout = 5s;
+    auto result = executor.Execute(request);
+    EXPECT_TRUE(result.success);
+    EXPECT_FALSE(result.timedOut);
+    EXPECT_EQ(result.output, "quick\n");
+}
+
+// Test an interrupted command leaves the persistent shell and its state
+TEST_F(CancellationTest, ShellSessionTimeout) {
+    ShellSession session(executor);
+    session.SetTimeout(200ms);
+    session.Execute("cd /usr; export X=1");
+
+    auto result = session.Execute("sleep 30");
+    EXPECT_TRUE(result.timedOut);
+    EXPECT_EQ(result.exitCode, 143);
+    EXPECT_TRUE(session.IsRunning());
+    EXPECT_EQ(result.error.find("state lost"), std::string::npos);
+
+    CancelToken cancel;
+    session.SetCancelToken(&cancel);
+    session.SetTimeout(0ms);
+    std::thread canceller = CancelLater(cancel, 200ms);
+    result = session.Execute("sleep 30");
+    canceller.join();
+    EXPECT_TRUE(result.cancelled);
+    EXPECT_EQ(result.exitCode, 130);
+    session.SetCancelToken(nullptr);
+
+    result = session.Execute("echo $(pwd) ${X:-fresh}");
+    EXPECT_EQ(result.output, "/usr 1\n");
+}
+
+// Test a shell that will not stop is killed, and the loss reported
+TEST_F(CancellationTest, ShellSessionKilled) {
+    ShellSession session(executor);
+    session.SetTimeout(200ms);
+    session.Execute("X=1");
+
+    auto result = session.Execute("while :; do :; done");
+    EXPECT_TRUE(result.timedOut);
+    EXPECT_FALSE(session.IsRunning());
+    EXPECT_NE(result.error.find("Shell session restarted, state lost"), std::string::npos);
+
+    session.SetTimeout(0ms);
+    result = session.Execute("echo ${X:-fresh}");
+    EXPECT_EQ(result.output, "fresh\n");
+}
+
+// Test the console applies its shell timeout and cancel requests
+TEST_F(CancellationTest, ConsoleTimeoutAndCancel) {
+    ClaudeConsole console;
+    ASSERT_TRUE(console.Initialize());
+
+    console.SetShellTimeout(200ms);
+    auto result = console.ExecuteCommand("sleep 30");
+    EXPECT_TRUE(result.timedOut);
+    EXPECT_NE(result.error.find("Timed out"), std::string::npos);
+
+    console.SetShellTimeout(0ms);
+    std::thread canceller([&console] {
+        std::this_thread::sleep_for(200ms);
+        console.RequestCancel();
+    });
+    result = console.ExecuteCommand("sleep 30");
+    canceller.join();
+    EXPECT_TRUE(result.cancelled);
+    EXPECT_NE(result.error.find("Cancelled"), std::string::npos);
+
+    // A request left over from before does not cancel the next command
+    console.RequestCancel();
+    result = console.ExecuteCommand("echo fine");
+    EXPECT_TRUE(result.success);
+    console.Shutdown();
+}
@@ -1,7 +1,11 @@
 #include <gtest/gtest.h>
 #include "ClaudeConsole.h"
 #include <chrono>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
 #include <thread>
+#include <unistd.h>
 
 using namespace cll;
 
@@ -28,6 +32,88 @@ TEST_F(ClaudeConsoleTest, InitializationTest) {
     EXPECT_FALSE(console->IsInMultiLineMode());
 }
 
+// Test JavaScript is only set up when something needs it
+TEST_F(ClaudeConsoleTest, JavaScriptStartsLazilyTest) {
+    EXPECT_FALSE(console->IsJavaScriptReady());
+    console->ExecuteCommand("pwd");
+    console->ExecuteCommand("echo shell only");
+    EXPECT_FALSE(console->IsJavaScriptReady());
+    
+    // Warming up does not make the isolate, which belongs to the first user
+    console->WarmUpJavaScript();
+    EXPECT_FALSE(console->IsJavaScriptReady());
+    
+    console->ExecuteJavaScript("1 + 1");
+    EXPECT_EQ(console->IsJavaScriptReady(), console->EnsureJavaScript());
+}
+
+// Test the snapshot is looked up next to the executable unless overridden,
+// and that a missing one leaves JavaScript building its own context
+TEST_F(ClaudeConsoleTest, StartupSnapshotPathTest) {
+    unsetenv("CLL_STARTUP_SNAPSHOT");
+    std::string path = ClaudeConsole::StartupSnapshotPath();
+    EXPECT_TRUE(path.ends_with(std::string("/") + ClaudeConsole::StartupSnapshotName));
+    
+    setenv("CLL_STARTUP_SNAPSHOT", "/nonexistent/cll_snapshot.bin", 1);
+    EXPECT_EQ(ClaudeConsole::StartupSnapshotPath(), "/nonexistent/cll_snapshot.bin");
+    console->EnsureJavaScript();
+    EXPECT_FALSE(console->UsesStartupSnapshot());
+    unsetenv("CLL_STARTUP_SNAPSHOT");
+    
+    std::string error;
+    if (!console->IsJavaScriptReady()) {
+        EXPECT_FALSE(ClaudeConsole::WriteStartupSnapshot("/tmp/cll_test_snapshot.bin", error));
+        EXPECT_FALSE(error.empty());
+    }
+}
+
+// Test files over the streaming threshold, and background loads, run in
+// order before the next JavaScript
+TEST_F(ClaudeConsoleTest, StreamedLoadTest) {
+    std::string output;
+    console->SetOutputCallback([&output](const std::string& text) { output += text; });
+    std::string path = std::filesystem::temp_directory_path() / ("cll_streamed_" + std::to_string(getpid()) + ".js");
+    std::ofstream(path) << "var streamed = (typeof streamed === 'number' ? streamed : 0) + 1;\n";
+    
+    console->SetStreamingThreshold(1);
+    bool javaScript = console->EnsureJavaScript();
+    EXPECT_EQ(console->ExecuteFile(path), javaScript);
+    EXPECT_EQ(console->LoadFileInBackground(path), javaScript);
+    EXPECT_EQ(console->PendingLoads(), javaScript ? 1u : 0u);
+    if (javaScript) {
+        output.clear();
+        console->ExecuteJavaScript("streamed");
+        EXPECT_EQ(console->PendingLoads(), 0u);
+        EXPECT_NE(output.find("2"), std::string::npos);
+    }
+    std::filesystem::remove(path);
+}
+
+// Test the message loop leaves V8 alone until it is started, then runs
+// the callbacks V8 posts
+TEST_F(ClaudeConsoleTest, MessageLoopTest) {
+    EXPECT_EQ(console->GetIdleTaskBudget(), ClaudeConsole::DefaultIdleTaskBudget);
+    EXPECT_EQ(console->PumpMessageLoop(), 0u);
+    console->RunIdleTasks();
+    EXPECT_FALSE(console->IsJavaScriptReady());
+    if (!console->EnsureJavaScript()) return;
+    
+    std::string output;
+    console->SetOutputCallback([&output](const std::string& text) { output += text; });
+    console->ExecuteJavaScript("var woken = 'waiting';"
+                               "Atomics.waitAsync(new Int32Array(new SharedArrayBuffer(4)), 0, 0, 5)"
+                               "    .value.then(result => { woken = result; })");
+    // The timeout is a delayed task: it runs at the first pump after it is due
+    for (int i = 0; i < 50; ++i) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        console->PumpMessageLoop();
+    }
+    console->RunIdleTasks();
+    output.clear();
+    console->ExecuteJavaScript("woken");
+    EXPECT_NE(output.find("timed-out"), std::string::npos);
+}
+
 // Mode switching tests
 TEST_F(ClaudeConsoleTest, ModeSwitchingTest) {
     // Test switching to JavaScript mode
@@ -0,0 +1,76 @@
+#include <gtest/gtest.h>
+#include "ClaudeConsole.h"
+#include "CodeCache.h"
+#include <filesystem>
+#include <fstream>
+#include <unistd.h>
+
+using namespace cll;
+namespace fs = std::filesystem;
+
+class CodeCacheTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        dir = fs::temp_directory_path() / ("cll_code_cache_" + std::to_string(getpid()));
+    }
+
+    void TearDown() override {
+        fs::remove_all(dir);
+    }
+
+    fs::path dir;
+};
+
+// Test data stored for a source is found for the same source only
+TEST_F(CodeCacheTest, StoresBySource) {
+    CodeCache cache(dir.string(), "12.4.254");
+    EXPECT_FALSE(cache.Find("var a = 1;"));
+    ASSERT_TRUE(cache.Store("var a = 1;", std::string("\0\1code", 6)));
+    EXPECT_TRUE(fs::exists(cache.PathFor("var a = 1;")));
+
+    auto data = cache.Find("var a = 1;");
+    ASSERT_TRUE(data);
+    EXPECT_EQ(*data, std::string("\0\1code", 6));
+    EXPECT_FALSE(cache.Find("var a = 2;"));
+
+    const auto& stats = cache.GetStats();
+    EXPECT_EQ(stats.misses, 2u);
+    EXPECT_EQ(stats.stored, 1u);
+    EXPECT_EQ(stats.bytesWritten, 6u);
+    EXPECT_EQ(stats.bytesRead, 6u);
+}
+
+// Test data from another engine version is a miss, not handed to V8
+TEST_F(CodeCacheTest, KeyedByEngineVersion) {
+    CodeCache older(dir.string(), "12.4.254");
+    ASSERT_TRUE(older.Store("f()", "data"));
+
+    CodeCache newer(dir.string(), "12.5.1");
+    EXPECT_FALSE(newer.Find("f()"));
+    EXPECT_EQ(newer.GetStats().misses, 1u);
+
+    // The newer engine's data replaces it
+    ASSERT_TRUE(newer.Store("f()", "newer"));
+    EXPECT_FALSE(older.Find("f()"));
+    EXPECT_EQ(newer.Find("f()"), "newer");
+}
+
+// Test rejected data is counted and its file dropped
+TEST_F(CodeCacheTest, RejectDropsFile) {
+    CodeCache cache(dir.string(), "12.4.254");
+    ASSERT_TRUE(cache.Store("g()", "stale"));
+    ASSERT_TRUE(cache.Find("g()"));
+    cache.Reject("g()");
+    EXPECT_EQ(cache.GetStats().rejected, 1u);
+    EXPECT_FALSE(fs::exists(cache.PathFor("g()")));
+    cache.Accept();
+    EXPECT_EQ(cache.GetStats().hits, 1u);
+}
+
+// Test the console keeps its cache in the config directory
+TEST(CodeCacheConsole, PathIsUnderConfig) {
+    ClaudeConsole console;
+    EXPECT_EQ(console.CodeCachePath(), console.GetConfigPath() + "/cache/code");
+    EXPECT_TRUE(console.GetCodeCache());
+    EXPECT_EQ(console.GetCodeCacheStats().hits, 0u);
+}
@@ -117,4 +117,45 @@ TEST_F(CommandExecutionTest, WhitespaceHandling) {
     result = console->ExecuteCommand("\t\tjs\t\t");
     EXPECT_TRUE(result.success);
     EXPECT_EQ(console->GetMode(), ConsoleMode::JavaScript);
-}
\ No newline at end of file
+}
+
+// Test streaming output delivers chunks through the output callback
+TEST_F(CommandExecutionTest, StreamingShellOutput) {
+    std::string streamed;
+    console->SetOutputCallback([&streamed](const std::string& text) {
+        streamed += text;
+    });
+    console->SetStreamingOutput(true);
+    
+    auto result = console->ExecuteCommand("printf 'first\\nsecond\\n'");
+    EXPECT_TRUE(result.success);
+    EXPECT_EQ(result.exitCode, 0);
+    EXPECT_EQ(streamed, "first\nsecond\n");
+    EXPECT_TRUE(result.output.empty());
+    EXPECT_GT(result.executionTime.count(), 0);
+}
+
+// Test chunks are bounded and arrive before the command exits
+TEST_F(CommandExecutionTest, StreamingChunkSink) {
+    size_t total = 0;
+    size_t largest = 0;
+    auto result = console->ExecuteShellCommand("head -c 300000 /dev/zero",
+        [&](std::string_view chunk) {
+            total += chunk.size();
+            largest = std::max(largest, chunk.size());
+        });
+    EXPECT_TRUE(result.success);
+    EXPECT_EQ(total, 300000u);
+    EXPECT_LE(largest, ClaudeConsole::StreamChunkSize);
+    
+    auto start = std::chrono::steady_clock::now();
+    std::chrono::steady_clock::duration firstChunk{};
+    result = console->ExecuteShellCommand("echo early; sleep 0.3; echo late",
+        [&](std::string_view) {
+            if (firstChunk == std::chrono::steady_clock::duration{}) {
+                firstChunk = std::chrono::steady_clock::now() - start;
+            }
+        });
+    EXPECT_TRUE(result.success);
+    EXPECT_LT(firstChunk, std::chrono::milliseconds(250));
+}
@@ -0,0 +1,178 @@
+#include <gtest/gtest.h>
+#include "ClaudeConsole.h"
+#include <cstdlib>
+#include <filesystem>
+#include <format>
+#include <thread>
+#include <unistd.h>
+
+using namespace cll;
+using namespace std::chrono_literals;
+
+class CommandSubstitutionTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        console = std::make_unique<ClaudeConsole>();
+        ASSERT_TRUE(console->Initialize());
+    }
+
+    void TearDown() override {
+        console->Shutdown();
+        console.reset();
+    }
+
+    // Commands found in a line, in order
+    static std::vector<std::string> Commands(const std::string& line) {
+        std::vector<ClaudeConsole::SubstitutionPart> parts;
+        ClaudeConsole::ParseSubstitutions(line, parts);
+        std::vector<std::string> commands;
+        for (const auto& part : parts) {
+            if (part.isCommand) commands.push_back(part.text);
+        }
+        return commands;
+    }
+
+    std::unique_ptr<ClaudeConsole> console;
+};
+
+// Test both forms are found and literals are kept around them
+TEST_F(CommandSubstitutionTest, ParsesBothForms) {
+    std::vector<ClaudeConsole::SubstitutionPart> parts;
+    ASSERT_TRUE(ClaudeConsole::ParseSubstitutions("a `b` c $(d) e", parts));
+    ASSERT_EQ(parts.size(), 5u);
+    EXPECT_EQ(parts[0].text, "a ");
+    EXPECT_FALSE(parts[0].isCommand);
+    EXPECT_EQ(parts[1].text, "b");
+    EXPECT_TRUE(parts[1].isCommand);
+    EXPECT_EQ(parts[3].text, "d");
+    EXPECT_EQ(parts[4].text, " e");
+
+    EXPECT_FALSE(ClaudeConsole::ParseSubstitutions("plain line", parts));
+}
+
+// Test nesting, quotes and escapes inside $( )
+TEST_F(CommandSubstitutionTest, ParsesNestedCommands) {
+    EXPECT_EQ(Commands("echo $(echo $(echo in))"), std::vector<std::string>{"echo $(echo in)"});
+    EXPECT_EQ(Commands("x $(echo \")\" ')' \\)) y"), std::vector<std::string>{"echo \")\" ')' \\)"});
+    EXPECT_EQ(Commands("x $(echo `echo )`)"), std::vector<std::string>{"echo `echo )`"});
+    EXPECT_EQ(Commands("`echo \\`x\\``"), std::vector<std::string>{"echo `x`"});
+}
+
+// Test what is not a substitution
+TEST_F(CommandSubstitutionTest, IgnoresNonCommands) {
+    EXPECT_TRUE(Commands("echo $((1 + 2))").empty());
+    EXPECT_TRUE(Commands("echo '$(date)' '`date`'").empty());
+    EXPECT_TRUE(Commands("echo \\$(date) \\`date\\`").empty());
+    EXPECT_TRUE(Commands("echo $(unclosed").empty());
+    EXPECT_TRUE(Commands("echo `unclosed").empty());
+    EXPECT_EQ(Commands("what's `echo up`"), std::vector<std::string>{"echo up"});
+}
+
+// Test output is spliced in order with trailing newlines removed
+TEST_F(CommandSubstitutionTest, ExpandsInOrder) {
+    auto result = console->ExecuteCommand("echo `echo a` $(printf 'b\\n\\n') `echo c`");
+    EXPECT_TRUE(result.success);
+    EXPECT_EQ(result.output, "a b c\n");
+
+    result = console->ExecuteCommand("echo $(echo $(echo nested))");
+    EXPECT_EQ(result.output, "nested\n");
+
+}
+
+// Test only Shell lines are expanded: $(sel) is jQuery in JavaScript
+TEST_F(CommandSubstitutionTest, OnlyShellLinesExpand) {
+    std::string marker = std::filesystem::temp_directory_path() / ("cll_subst_" + std::to_string(getpid()));
+    std::string line = "var el = $(touch " + marker + ")";
+    console->ExecuteCommand("&" + line);
+    console->SetMode(ConsoleMode::JavaScript);
+    auto result = console->ExecuteCommand(line);
+    EXPECT_FALSE(std::filesystem::exists(marker));
+    if (!console->IsJavaScriptReady()) {
+        EXPECT_NE(result.output.find(line), std::string::npos);
+    }
+
+    console->SetMode(ConsoleMode::Shell);
+    EXPECT_EQ(console->ExecuteCommand("$echo $(echo shell)").output, "shell\n");
+    std::filesystem::remove(marker);
+}
+
+// Test the persistent shell expands substitutions in its own state
+TEST_F(CommandSubstitutionTest, PersistentShellExpands) {
+    console->SetPersistentShell(true);
+    console->ExecuteCommand("cd /usr; CLL_SUBST=bar; export CLL_SUBST");
+    EXPECT_EQ(console->ExecuteCommand("echo [$(pwd)] [`echo $CLL_SUBST`]").output, "[/usr] [bar]\n");
+}
+
+// Test a substitution's stderr is reported rather than dropped
+TEST_F(CommandSubstitutionTest, ReportsErrors) {
+    std::string errors;
+    console->SetErrorCallback([&errors](const std::string& text) { errors += text; });
+    auto result = console->ExecuteCommand("echo [$(ls /cll_no_such_path)]");
+    EXPECT_EQ(result.output, "[]\n");
+    EXPECT_NE(errors.find("/cll_no_such_path"), std::string::npos);
+    EXPECT_EQ(errors.back(), '\n');
+}
+
+// Test substituted text is passed by name rather than spliced into the line
+TEST_F(CommandSubstitutionTest, OutputIsNotExpandedAgain) {
+    std::string expanded;
+    ClaudeConsole::SubstitutionVariables variables;
+    ASSERT_TRUE(console->ExpandSubstitutions("let s = $(echo '`echo twice`')", expanded, variables));
+    EXPECT_EQ(expanded, "let s = ${CLL_SUB_0}");
+    ASSERT_EQ(variables.size(), 1u);
+    EXPECT_EQ(variables[0].first, "CLL_SUB_0");
+    EXPECT_EQ(variables[0].second, "`echo twice`");
+    EXPECT_FALSE(console->ExpandSubstitutions("no commands", expanded, variables));
+}
+
+// Test output holding shell syntax is never run as shell code
+TEST_F(CommandSubstitutionTest, OutputIsNotShellCode) {
+    auto result = console->ExecuteCommand("echo $(printf '%s' 'x; echo INJECTED')");
+    EXPECT_EQ(result.output, "x; echo INJECTED\n");
+    result = console->ExecuteCommand("echo `printf '%s' '$(echo run)'` \"$(printf '%s' '`echo run`')\"");
+    EXPECT_EQ(result.output, "$(echo run) `echo run`\n");
+    result = console->ExecuteCommand("echo `printf '$HOME'`");
+    EXPECT_EQ(result.output, "$HOME\n");
+
+    // The variables are gone once the line has run
+    EXPECT_EQ(getenv("CLL_SUB_0"), nullptr);
+}
+
+// Test unquoted output is still split into words, as in the shell
+TEST_F(CommandSubstitutionTest, OutputIsSplitUnlessQuoted) {
+    EXPECT_EQ(console->ExecuteCommand("printf '[%s]' $(echo a b)").output, "[a][b]");
+    EXPECT_EQ(console->ExecuteCommand("printf '[%s]' \"$(echo a b)\"").output, "[a b]");
+}
+
+// Test independent substitutions run concurrently
+TEST_F(CommandSubstitutionTest, RunsConcurrently) {
+    auto start = std::chrono::steady_clock::now();
+    auto result = console->ExecuteCommand("echo $(sleep 0.4; echo 1) $(sleep 0.4; echo 2) `sleep 0.4; echo 3`");
+    auto elapsed = std::chrono::steady_clock::now() - start;
+    EXPECT_EQ(result.output, "1 2 3\n");
+    EXPECT_LT(elapsed, 1000ms);
+}
+
+// Test more substitutions than workers still all run
+TEST_F(CommandSubstitutionTest, MoreCommandsThanWorkers) {
+    std::string line = "echo";
+    std::string expected;
+    for (size_t i = 0; i < ClaudeConsole::MaxSubstitutionWorkers * 2 + 1; ++i) {
+        line += std::format(" $(echo {})", i);
+        expected += (i ? " " : "") + std::to_string(i);
+    }
+    EXPECT_EQ(console->ExecuteCommand(line).output, expected + "\n");
+}
+
+// Test cancelling stops every running substitution
+TEST_F(CommandSubstitutionTest, CancelStopsAll) {
+    std::thread canceller([this] {
+        std::this_thread::sleep_for(200ms);
+        console->RequestCancel();
+    });
+    auto start = std::chrono::steady_clock::now();
+    auto result = console->ExecuteCommand("echo $(sleep 30) $(sleep 30)");
+    canceller.join();
+    EXPECT_TRUE(result.cancelled);
+    EXPECT_LT(std::chrono::steady_clock::now() - start, 5s);
+}
@@ -1,5 +1,6 @@
 #include <gtest/gtest.h>
 #include "ClaudeConsole.h"
+#include <cstdlib>
 #include <filesystem>
 #include <fstream>
 
@@ -129,4 +130,29 @@ TEST_F(ConfigurationTest, AliasFileStructure) {
     
     // Should contain header comment
     EXPECT_TRUE(content.find("# Claude Console Aliases") != std::string::npos);
-}
\ No newline at end of file
+}
+
+// Test keys of the wrong type or out of range keep their defaults
+TEST_F(ConfigurationTest, BadValuesFallBack) {
+    std::string home = std::getenv("HOME") ? std::getenv("HOME") : "";
+    setenv("HOME", tempConfigPath.c_str(), 1);
+    fs::create_directories(tempConfigPath / ".config/cll");
+    std::ofstream(tempConfigPath / ".config/cll/config.json") << R"({
+        "command_timeout_seconds": "30",
+        "code_cache": "yes",
+        "script_cache_size": -5,
+        "idle_task_ms": 7,
+        "command_limits": {"nice": 99, "memory_mb": -1, "cpu_seconds": 3}
+    })";
+
+    std::unique_ptr<ClaudeConsole> configured;
+    EXPECT_NO_THROW(configured = std::make_unique<ClaudeConsole>());
+    setenv("HOME", home.c_str(), 1);
+    ASSERT_TRUE(configured);
+    EXPECT_EQ(configured->GetShellTimeout().count(), 0);
+    EXPECT_TRUE(configured->GetCodeCache());
+    EXPECT_EQ(configured->GetScriptCacheCapacity(), ClaudeConsole::DefaultScriptCacheCapacity);
+    EXPECT_EQ(configured->GetCommandLimits().nice, 0);
+    EXPECT_EQ(configured->GetCommandLimits().addressSpace, 0u);
+    configured->Shutdown();
+}
@@ -0,0 +1,106 @@
+#include <gtest/gtest.h>
+#include "ClaudeConsole.h"
+#include "ProcessExecutor.h"
+#include <filesystem>
+#include <fstream>
+#include <unistd.h>
+
+using namespace cll;
+namespace fs = std::filesystem;
+
+class DirectExecTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        dir = fs::temp_directory_path() / ("cll_direct_exec_" + std::to_string(getpid()));
+        fs::create_directories(dir);
+        for (const char* name : {"b.txt", "a.txt", "c.log", "x*y", "xz"}) {
+            std::ofstream(dir / name) << name << "\n";
+        }
+        ASSERT_TRUE(console.Initialize());
+    }
+
+    void TearDown() override {
+        console.Shutdown();
+        fs::remove_all(dir);
+    }
+
+    std::vector<std::string> Split(const std::string& line) {
+        std::vector<std::string> words;
+        EXPECT_TRUE(ClaudeConsole::SplitSimpleCommand(line, words, true)) << line;
+        return words;
+    }
+
+    fs::path dir;
+    ClaudeConsole console;
+};
+
+// Test unquoted patterns expand in order and quoted ones stay literal
+TEST_F(DirectExecTest, ExpandsGlobs) {
+    std::string d = dir.string();
+    EXPECT_EQ(Split("ls " + d + "/*.txt"), (std::vector<std::string>{"ls", d + "/a.txt", d + "/b.txt"}));
+    EXPECT_EQ(Split("ls '" + d + "/*.txt'"), (std::vector<std::string>{"ls", d + "/*.txt"}));
+    EXPECT_EQ(Split("ls " + d + "/'x*'*"), (std::vector<std::string>{"ls", d + "/x*y"}));
+    EXPECT_EQ(Split("ls " + d + "/[ab].txt " + d + "/?.log"),
+              (std::vector<std::string>{"ls", d + "/a.txt", d + "/b.txt", d + "/c.log"}));
+
+    // No match leaves the word as typed, like the shell
+    EXPECT_EQ(Split("ls " + d + "/*.cpp"), (std::vector<std::string>{"ls", d + "/*.cpp"}));
+}
+
+// Test which lines are exec'd directly
+TEST_F(DirectExecTest, ClassifiesLines) {
+    std::vector<std::string> argv;
+    EXPECT_TRUE(console.IsDirectCommand("ls -l 'a b'", argv));
+    EXPECT_EQ(argv, (std::vector<std::string>{"ls", "-l", "a b"}));
+
+    EXPECT_FALSE(console.IsDirectCommand("ls | wc -l", argv));
+    EXPECT_FALSE(console.IsDirectCommand("ls > /dev/null", argv));
+    EXPECT_FALSE(console.IsDirectCommand("ls $HOME", argv));
+    EXPECT_FALSE(console.IsDirectCommand("FOO=1 env", argv));
+    EXPECT_FALSE(console.IsDirectCommand("cd -P /", argv));
+    EXPECT_FALSE(console.IsDirectCommand("test -d /", argv));
+    EXPECT_FALSE(console.IsDirectCommand("cll_no_such_program_xyz", argv));
+    EXPECT_FALSE(console.IsDirectCommand("ls /\necho b", argv));
+    EXPECT_FALSE(console.IsDirectCommand("ls /\r\n", argv));
+
+    console.SetPersistentShell(true);
+    EXPECT_FALSE(console.IsDirectCommand("ls -l", argv));
+}
+
+// Test direct lines behave as they would under /bin/sh
+TEST_F(DirectExecTest, RunsLikeTheShell) {
+    std::string d = dir.string();
+    auto result = console.ExecuteCommand("cat " + d + "/*.txt");
+    EXPECT_TRUE(result.success);
+    EXPECT_EQ(result.output, "a.txt\nb.txt\n");
+
+    // Each line of a multi-line command is a command of its own
+    result = console.CaptureShellCommand("ls " + d + "/a.txt\necho b");
+    EXPECT_EQ(result.output, d + "/a.txt\nb\n");
+
+    result = console.ExecuteCommand("ls " + d + "/nothing");
+    EXPECT_EQ(result.exitCode, 2);
+    EXPECT_NE(result.error.find("nothing"), std::string::npos);
+
+    // A script without a #! line is still run by the shell
+    fs::path script = dir / "plain";
+    std::ofstream(script) << "echo plain $1\n";
+    fs::permissions(script, fs::perms::owner_all);
+    result = console.ExecuteCommand(script.string() + " arg");
+    EXPECT_EQ(result.output, "plain arg\n");
+}
+
+// Test both spawn paths fall back to the shell for scripts without #!
+TEST_F(DirectExecTest, ScriptWithoutInterpreter) {
+    fs::path script = dir / "plain";
+    std::ofstream(script) << "echo plain $1\n";
+    fs::permissions(script, fs::perms::owner_all);
+
+    ProcessExecutor executor;
+    ProcessRequest request;
+    request.argv = {script.string(), "x"};
+    EXPECT_EQ(executor.Execute(request).output, "plain x\n");
+    ASSERT_TRUE(executor.StartServer());
+    EXPECT_EQ(executor.Execute(request).output, "plain x\n");
+    executor.StopServer();
+}
@@ -0,0 +1,148 @@
+#include <gtest/gtest.h>
+#include "ClaudeConsole.h"
+#include "JobTable.h"
+#include <thread>
+
+using namespace cll;
+
+class JobControlTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        console = std::make_unique<ClaudeConsole>();
+        ASSERT_TRUE(console->Initialize());
+    }
+
+    void TearDown() override {
+        console->Shutdown();
+        console.reset();
+    }
+
+    std::unique_ptr<ClaudeConsole> console;
+};
+
+// Test which lines count as background commands
+TEST_F(JobControlTest, BackgroundCommandDetection) {
+    EXPECT_TRUE(ClaudeConsole::IsBackgroundCommand("sleep 1 &"));
+    EXPECT_TRUE(ClaudeConsole::IsBackgroundCommand("make&  "));
+    EXPECT_FALSE(ClaudeConsole::IsBackgroundCommand("a &&"));
+    EXPECT_FALSE(ClaudeConsole::IsBackgroundCommand("echo \\&"));
+    EXPECT_FALSE(ClaudeConsole::IsBackgroundCommand("&"));
+    EXPECT_FALSE(ClaudeConsole::IsBackgroundCommand("echo a && echo b"));
+}
+
+// Test a trailing & returns at once and the job reports when done
+TEST_F(JobControlTest, BackgroundJobReportsLater) {
+    auto result = console->ExecuteCommand("sleep 0.3; echo finished &");
+    EXPECT_TRUE(result.success);
+    EXPECT_EQ(result.output.rfind("[1] ", 0), 0u);
+    EXPECT_LT(result.executionTime.count(), 300000);
+
+    result = console->ExecuteCommand("jobs");
+    EXPECT_NE(result.output.find("Running"), std::string::npos);
+    EXPECT_TRUE(console->TakeFinishedJobs().empty());
+
+    std::vector<JobReport> finished;
+    for (int i = 0; i < 100 && finished.empty(); ++i) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+        finished = console->TakeFinishedJobs();
+    }
+    ASSERT_EQ(finished.size(), 1u);
+    EXPECT_EQ(finished[0].id, 1);
+    EXPECT_EQ(finished[0].result.output, "finished\n");
+    EXPECT_EQ(finished[0].result.exitCode, 0);
+    EXPECT_GE(finished[0].result.executionTime.count(), 300000);
+
+    std::string text = ClaudeConsole::FormatJobReport(finished[0]);
+    EXPECT_NE(text.find("[1]  Done"), std::string::npos);
+    EXPECT_NE(text.find("finished"), std::string::npos);
+}
+
+// Test fg and wait return a job's result and exit code
+TEST_F(JobControlTest, ForegroundAndWait) {
+    console->ExecuteCommand("echo one; exit 3 &");
+    console->ExecuteCommand("echo two >&2 &");
+
+    auto result = console->ExecuteCommand("fg %1");
+    EXPECT_FALSE(result.success);
+    EXPECT_EQ(result.exitCode, 3);
+    EXPECT_EQ(result.output, "one\n");
+
+    result = console->ExecuteCommand("wait");
+    EXPECT_TRUE(result.success);
+    EXPECT_NE(result.output.find("[2]  Done"), std::string::npos);
+    EXPECT_NE(result.output.find("two"), std::string::npos);
+
+    result = console->ExecuteCommand("fg");
+    EXPECT_FALSE(result.success);
+    result = console->ExecuteCommand("wait 7");
+    EXPECT_FALSE(result.success);
+}
+
+// Test bg resumes a stopped job
+TEST_F(JobControlTest, ResumeStoppedJob) {
+    auto result = console->ExecuteCommand("kill -STOP $$; echo resumed &");
+    ASSERT_TRUE(result.success);
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+
+    result = console->ExecuteCommand("bg %1");
+    EXPECT_TRUE(result.success);
+    result = console->ExecuteCommand("wait %1");
+    EXPECT_EQ(result.output, "resumed\n");
+}
+
+// Test Ctrl-C at fg interrupts the job, and at wait only the wait
+TEST_F(JobControlTest, CancelForegroundAndWait) {
+    auto cancelSoon = [this] {
+        return std::thread([this] {
+            std::this_thread::sleep_for(std::chrono::milliseconds(200));
+            console->RequestCancel();
+        });
+    };
+
+    console->ExecuteCommand("sleep 30 &");
+    auto start = std::chrono::steady_clock::now();
+    std::thread canceller = cancelSoon();
+    auto result = console->ExecuteCommand("wait");
+    canceller.join();
+    EXPECT_TRUE(result.cancelled);
+    EXPECT_EQ(result.exitCode, 130);
+    EXPECT_LT(std::chrono::steady_clock::now() - start, std::chrono::seconds(5));
+    EXPECT_NE(console->ExecuteCommand("jobs").output.find("Running"), std::string::npos);
+
+    canceller = cancelSoon();
+    result = console->ExecuteCommand("fg");
+    canceller.join();
+    EXPECT_TRUE(result.cancelled);
+    EXPECT_FALSE(result.success);
+    EXPECT_NE(result.error.find("Cancelled"), std::string::npos);
+    EXPECT_LT(std::chrono::steady_clock::now() - start, std::chrono::seconds(5));
+    EXPECT_TRUE(console->ExecuteCommand("jobs").output.empty());
+}
+
+// Test job control words are only taken from Shell lines
+TEST_F(JobControlTest, ShellModeOnly) {
+    EXPECT_FALSE(console->IsBuiltinCommand("wait"));
+    console->SetMode(ConsoleMode::Ask);
+    auto result = console->ExecuteCommand("wait what is the capital of france");
+    EXPECT_EQ(result.output, "Paris");
+
+    console->SetMode(ConsoleMode::Shell);
+    result = console->ExecuteCommand("wait 7");
+    EXPECT_NE(result.error.find("wait: %7: no such job"), std::string::npos);
+}
+
+// Test the output tail keeps only the end of long output
+TEST_F(JobControlTest, OutputTailIsBounded) {
+    console->ExecuteCommand("head -c 100000 /dev/zero | tr '\\0' x; echo END &");
+    auto result = console->ExecuteCommand("wait %1");
+    EXPECT_EQ(result.output.size(), JobTable::OutputTailSize);
+    EXPECT_EQ(result.output.substr(result.output.size() - 4), "END\n");
+}
+
+// Test shutdown does not hang on running jobs
+TEST_F(JobControlTest, ShutdownTerminatesJobs) {
+    console->ExecuteCommand("sleep 30 &");
+    auto start = std::chrono::steady_clock::now();
+    console->Shutdown();
+    EXPECT_LT(std::chrono::steady_clock::now() - start, std::chrono::seconds(5));
+}
@@ -0,0 +1,71 @@
+#include <gtest/gtest.h>
+#include "ClaudeConsole.h"
+#include "LruCache.h"
+#include <memory>
+
+using namespace cll;
+
+// Test the least recently used entry is the one evicted
+TEST(LruCache, EvictsLeastRecentlyUsed) {
+    LruCache<int> cache(2);
+    cache.Insert("a", 1);
+    cache.Insert("b", 2);
+    ASSERT_NE(cache.Find("a"), nullptr);
+    cache.Insert("c", 3);
+
+    EXPECT_EQ(cache.Find("b"), nullptr);
+    ASSERT_NE(cache.Find("a"), nullptr);
+    EXPECT_EQ(*cache.Find("c"), 3);
+
+    auto stats = cache.GetStats();
+    EXPECT_EQ(stats.hits, 3u);
+    EXPECT_EQ(stats.misses, 1u);
+    EXPECT_EQ(stats.evictions, 1u);
+    EXPECT_EQ(stats.entries, 2u);
+    EXPECT_EQ(stats.keyBytes, 2u);
+    EXPECT_DOUBLE_EQ(stats.HitRate(), 0.75);
+}
+
+// Test values may be move-only, and replacing one keeps a single entry
+TEST(LruCache, HoldsMoveOnlyValues) {
+    LruCache<std::unique_ptr<int>> cache(4);
+    cache.Insert("x", std::make_unique<int>(1));
+    cache.Insert("x", std::make_unique<int>(2));
+    EXPECT_EQ(cache.Size(), 1u);
+    EXPECT_EQ(**cache.Find("x"), 2);
+}
+
+// Test shrinking evicts, and zero capacity caches nothing
+TEST(LruCache, CapacityChanges) {
+    LruCache<int> cache(3);
+    cache.Insert("a", 1);
+    cache.Insert("b", 2);
+    cache.Insert("c", 3);
+    cache.SetCapacity(1);
+    EXPECT_EQ(cache.Size(), 1u);
+    EXPECT_NE(cache.Find("c"), nullptr);
+    EXPECT_EQ(cache.GetStats().evictions, 2u);
+
+    cache.SetCapacity(0);
+    cache.Insert("d", 4);
+    EXPECT_EQ(cache.Size(), 0u);
+    EXPECT_EQ(cache.GetStats().keyBytes, 0u);
+}
+
+// Test the console's script cache is configurable and reports stats
+TEST(LruCache, ConsoleScriptCache) {
+    ClaudeConsole console;
+    EXPECT_EQ(console.GetScriptCacheCapacity(), ClaudeConsole::DefaultScriptCacheCapacity);
+    console.SetScriptCacheCapacity(8);
+    EXPECT_EQ(console.GetScriptCacheStats().capacity, 8u);
+    console.ExecuteJavaScript("1 + 1");
+    console.ExecuteJavaScript("1 + 1");
+    auto stats = console.GetScriptCacheStats();
+    if (console.IsJavaScriptReady()) {
+        // init.js, if the user has one, may have added its own
+        EXPECT_GE(stats.hits, 1u);
+        EXPECT_GE(stats.entries, 1u);
+    } else {
+        EXPECT_EQ(stats.entries, 0u);
+    }
+}
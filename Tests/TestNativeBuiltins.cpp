@@ -0,0 +1,110 @@
+#include <gtest/gtest.h>
+#include "ClaudeConsole.h"
+#include <cstdlib>
+#include <filesystem>
+
+using namespace cll;
+
+class NativeBuiltinsTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        savedPath = std::filesystem::current_path();
+        console = std::make_unique<ClaudeConsole>();
+        ASSERT_TRUE(console->Initialize());
+    }
+
+    void TearDown() override {
+        console->Shutdown();
+        console.reset();
+        std::filesystem::current_path(savedPath);
+    }
+
+    std::filesystem::path savedPath;
+    std::unique_ptr<ClaudeConsole> console;
+};
+
+// Test which lines are simple enough to run natively
+TEST_F(NativeBuiltinsTest, SplitSimpleCommand) {
+    std::vector<std::string> words;
+    EXPECT_TRUE(ClaudeConsole::SplitSimpleCommand("echo 'a  b' \"c d\"e", words));
+    EXPECT_EQ(words, (std::vector<std::string>{"echo", "a  b", "c de"}));
+
+    EXPECT_FALSE(ClaudeConsole::SplitSimpleCommand("echo $HOME", words));
+    EXPECT_FALSE(ClaudeConsole::SplitSimpleCommand("echo a | wc", words));
+    EXPECT_FALSE(ClaudeConsole::SplitSimpleCommand("echo a > /dev/null", words));
+    EXPECT_FALSE(ClaudeConsole::SplitSimpleCommand("echo *.cpp", words));
+    EXPECT_FALSE(ClaudeConsole::SplitSimpleCommand("echo \"$PATH\"", words));
+    EXPECT_FALSE(ClaudeConsole::SplitSimpleCommand("echo 'open", words));
+    EXPECT_TRUE(ClaudeConsole::SplitSimpleCommand("echo '$HOME'", words));
+    EXPECT_EQ(words[1], "$HOME");
+}
+
+// Test cd and pwd change and report this process's directory
+TEST_F(NativeBuiltinsTest, CdAndPwd) {
+    auto result = console->ExecuteCommand("cd /tmp");
+    EXPECT_TRUE(result.success);
+    EXPECT_EQ(std::filesystem::current_path(), "/tmp");
+    EXPECT_EQ(console->ExecuteCommand("pwd").output, "/tmp\n");
+
+    // Child processes start in the new directory
+    EXPECT_EQ(console->ExecuteCommand("pwd | cat").output, "/tmp\n");
+
+    console->ExecuteCommand("cd /");
+    result = console->ExecuteCommand("cd -");
+    EXPECT_EQ(result.output, "/tmp\n");
+
+    result = console->ExecuteCommand("cd /cll_no_such_directory");
+    EXPECT_FALSE(result.success);
+    EXPECT_NE(result.error.find("/cll_no_such_directory"), std::string::npos);
+    EXPECT_EQ(std::filesystem::current_path(), "/tmp");
+}
+
+// Test export reaches later commands
+TEST_F(NativeBuiltinsTest, ExportAndEnv) {
+    auto result = console->ExecuteCommand("export CLL_NATIVE_TEST='hello world'");
+    EXPECT_TRUE(result.success);
+    EXPECT_STREQ(std::getenv("CLL_NATIVE_TEST"), "hello world");
+    EXPECT_EQ(console->ExecuteCommand("echo \"$CLL_NATIVE_TEST\" | cat").output, "hello world\n");
+    EXPECT_NE(console->ExecuteCommand("env").output.find("CLL_NATIVE_TEST=hello world\n"), std::string::npos);
+
+    result = console->ExecuteCommand("export 1BAD=x");
+    EXPECT_FALSE(result.success);
+    unsetenv("CLL_NATIVE_TEST");
+}
+
+// Test echo and which match the shell's output
+TEST_F(NativeBuiltinsTest, EchoAndWhich) {
+    EXPECT_EQ(console->ExecuteCommand("echo hello   world").output, "hello world\n");
+    EXPECT_EQ(console->ExecuteCommand("echo -n 'no newline'").output, "no newline");
+    EXPECT_EQ(console->ExecuteCommand("echo").output, "\n");
+
+    auto result = console->ExecuteCommand("which sh");
+    EXPECT_TRUE(result.success);
+    EXPECT_EQ(result.output, console->ExecuteCommand("command -v sh").output);
+
+    result = console->ExecuteCommand("which cll_no_such_program_xyz");
+    EXPECT_FALSE(result.success);
+    EXPECT_TRUE(result.output.empty());
+}
+
+// Test a builtin followed by more lines leaves them to the shell
+TEST_F(NativeBuiltinsTest, MultiLineCommands) {
+    EXPECT_EQ(console->CaptureShellCommand("echo a\necho b").output, "a\nb\n");
+
+    // cd and export then only touch the shell that runs the script
+    auto result = console->CaptureShellCommand("cd /\nexport CLL_NATIVE_LINES=1\npwd");
+    EXPECT_EQ(result.output, "/\n");
+    EXPECT_EQ(std::filesystem::current_path(), savedPath);
+    EXPECT_EQ(std::getenv("CLL_NATIVE_LINES"), nullptr);
+}
+
+// Test builtins only apply to Shell commands
+TEST_F(NativeBuiltinsTest, NotUsedOutsideShellMode) {
+    EXPECT_TRUE(console->IsNativeBuiltin("echo hi"));
+    EXPECT_FALSE(console->IsBuiltinCommand("echo hi"));
+    EXPECT_FALSE(console->IsNativeBuiltin("ls"));
+
+    console->SetMode(ConsoleMode::Ask);
+    auto result = console->ExecuteCommand("which is the capital of france");
+    EXPECT_EQ(result.output, "Paris");
+}
@@ -0,0 +1,170 @@
+#include <gtest/gtest.h>
+#include "ClaudeConsole.h"
+#include "OutputStore.h"
+#include <cstdlib>
+#include <filesystem>
+#include <sstream>
+#include <sys/resource.h>
+#include <unistd.h>
+
+using namespace cll;
+namespace fs = std::filesystem;
+
+class OutputStoreTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        const char* tmp = std::getenv("TMPDIR");
+        savedTmp = tmp ? tmp : "";
+        spillDir = fs::temp_directory_path() / ("cll_spill_" + std::to_string(getpid()));
+        fs::create_directories(spillDir);
+        setenv("TMPDIR", spillDir.c_str(), 1);
+    }
+
+    void TearDown() override {
+        if (savedTmp.empty()) {
+            unsetenv("TMPDIR");
+        } else {
+            setenv("TMPDIR", savedTmp.c_str(), 1);
+        }
+        fs::remove_all(spillDir);
+    }
+
+    static long PeakRssKb() {
+        rusage usage{};
+        getrusage(RUSAGE_SELF, &usage);
+        return usage.ru_maxrss;
+    }
+
+    std::string savedTmp;
+    fs::path spillDir;
+};
+
+// Test output under the threshold stays in memory
+TEST_F(OutputStoreTest, SmallOutputStaysInMemory) {
+    OutputStore store(1024);
+    store.Append("hello ");
+    store.Append("world");
+    EXPECT_FALSE(store.Spilled());
+
+    CommandResult result{true, "", "", std::chrono::microseconds(0), 0};
+    store.Finish(result);
+    EXPECT_EQ(result.output, "hello world");
+    EXPECT_EQ(result.spilledOutput, nullptr);
+    EXPECT_EQ(result.OutputView(), "hello world");
+}
+
+// Test output past the threshold moves to an unlinked mapped file
+TEST_F(OutputStoreTest, LargeOutputSpills) {
+    OutputStore store(1000);
+    std::string expected;
+    for (int i = 0; i < 100; ++i) {
+        std::string chunk = std::string(100, static_cast<char>('a' + i % 26)) + '\0';
+        store.Append(chunk);
+        expected += chunk;
+    }
+    EXPECT_TRUE(store.Spilled());
+    EXPECT_TRUE(fs::is_empty(spillDir));
+
+    CommandResult result{true, "", "", std::chrono::microseconds(0), 0};
+    store.Finish(result);
+    ASSERT_NE(result.spilledOutput, nullptr);
+    EXPECT_TRUE(result.output.empty());
+    EXPECT_TRUE(result.error.empty());
+    EXPECT_EQ(result.OutputView(), expected);
+
+    std::ostringstream printed;
+    result.spilledOutput->WriteTo(printed);
+    EXPECT_EQ(printed.str(), expected);
+    // Dropped pages come back from the file
+    EXPECT_EQ(result.OutputView(), expected);
+}
+
+// Test a zero threshold never spills
+TEST_F(OutputStoreTest, ZeroThresholdKeepsEverything) {
+    OutputStore store(0);
+    store.Append(std::string(1 << 20, 'x'));
+    EXPECT_FALSE(store.Spilled());
+    EXPECT_EQ(store.Size(), 1u << 20);
+}
+
+// Test the console spills big captured output without growing its memory
+TEST_F(OutputStoreTest, ConsoleSpillsLargeOutput) {
+    ClaudeConsole console;
+    ASSERT_TRUE(console.Initialize());
+    console.SetOutputSpillThreshold(1 << 20);
+
+    auto result = console.ExecuteCommand("echo small");
+    EXPECT_EQ(result.output, "small\n");
+    EXPECT_EQ(result.spilledOutput, nullptr);
+
+    long before = PeakRssKb();
+    result = console.ExecuteCommand("head -c 100000000 /dev/zero | tr '\\0' x");
+    ASSERT_TRUE(result.success);
+    ASSERT_NE(result.spilledOutput, nullptr);
+    EXPECT_TRUE(result.output.empty());
+    EXPECT_EQ(result.OutputView().size(), 100000000u);
+    EXPECT_EQ(result.OutputView().substr(99999990), "xxxxxxxxxx");
+    EXPECT_LT(PeakRssKb() - before, 40 * 1024);
+    console.Shutdown();
+}
+
+// Test each retention policy keeps the right ends, whatever the chunk sizes
+TEST_F(OutputStoreTest, RetentionPolicies) {
+    std::string data;
+    for (int i = 0; i < 5000; ++i) {
+        data += std::to_string(i) + "\n";
+    }
+
+    struct Case {
+        OutputRetention retention;
+        std::string expected;
+    };
+    Case cases[] = {
+        {OutputRetention::Head, data.substr(0, 100)},
+        {OutputRetention::Tail, data.substr(data.size() - 100)},
+        {OutputRetention::HeadAndTail, data.substr(0, 100) + data.substr(data.size() - 100)},
+    };
+    for (const auto& test : cases) {
+        for (size_t chunkSize : {1, 7, 99, 100, 101, 4096}) {
+            OutputStore store(1 << 10, test.retention, 100);
+            for (size_t offset = 0; offset < data.size(); offset += chunkSize) {
+                store.Append(std::string_view(data).substr(offset, chunkSize));
+            }
+            CommandResult result;
+            store.Finish(result);
+            EXPECT_FALSE(store.Spilled());
+            EXPECT_EQ(result.output, test.expected) << "chunk size " << chunkSize;
+            EXPECT_EQ(result.droppedBytes, data.size() - test.expected.size());
+        }
+    }
+
+    // Short output is kept whole, with nothing counted as dropped
+    OutputStore store(0, OutputRetention::HeadAndTail, 100);
+    store.Append("short\n");
+    CommandResult result;
+    store.Finish(result);
+    EXPECT_EQ(result.output, "short\n");
+    EXPECT_EQ(result.droppedBytes, 0u);
+}
+
+// Test the console bounds what it keeps while streaming everything
+TEST_F(OutputStoreTest, ConsoleRetention) {
+    ClaudeConsole console;
+    ASSERT_TRUE(console.Initialize());
+    console.SetOutputRetention(OutputRetention::Tail, 8);
+
+    auto result = console.ExecuteCommand("seq 1 1000");
+    EXPECT_EQ(result.output, "99\n1000\n");
+    EXPECT_EQ(result.droppedBytes, 3893u - 8u);
+    EXPECT_NE(ClaudeConsole::FormatExecutionTime(result).find("dropped"), std::string::npos);
+
+    size_t streamed = 0;
+    console.SetOutputCallback([&](const std::string& text) { streamed += text.size(); });
+    console.SetStreamingOutput(true);
+    console.SetOutputRetention(OutputRetention::Head, 4);
+    console.ExecuteCommand("seq 1 1000");
+    EXPECT_EQ(streamed, 3893u);
+    EXPECT_EQ(console.GetLastResult().output, "1\n2\n");
+    EXPECT_EQ(console.GetLastResult().droppedBytes, 3889u);
+    console.Shutdown();
+}
@@ -0,0 +1,118 @@
+#include <gtest/gtest.h>
+#include "ClaudeConsole.h"
+#include "PathCache.h"
+#include "ProcessExecutor.h"
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <unistd.h>
+
+using namespace cll;
+namespace fs = std::filesystem;
+
+class PathCacheTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        savedPath = std::getenv("PATH");
+        binDir = fs::temp_directory_path() / ("cll_path_cache_" + std::to_string(getpid()));
+        fs::create_directories(binDir);
+        setenv("PATH", (binDir.string() + ":" + savedPath).c_str(), 1);
+    }
+
+    void TearDown() override {
+        setenv("PATH", savedPath.c_str(), 1);
+        fs::remove_all(binDir);
+    }
+
+    fs::path MakeProgram(const std::string& name) {
+        fs::path program = binDir / name;
+        std::ofstream(program) << "#!/bin/sh\necho from " << name << "\n";
+        fs::permissions(program, fs::perms::owner_all);
+        return program;
+    }
+
+    std::string savedPath;
+    fs::path binDir;
+    PathCache cache;
+};
+
+// Test lookups follow PATH order
+TEST_F(PathCacheTest, FindsProgramsInPathOrder) {
+    EXPECT_FALSE(cache.Find("sh").empty());
+    EXPECT_TRUE(cache.Find("cll_no_such_program_xyz").empty());
+    EXPECT_EQ(cache.Find("/bin/sh"), "/bin/sh");
+
+    // A copy earlier in PATH shadows the system one
+    fs::path shadow = MakeProgram("sh");
+    EXPECT_EQ(cache.Find("sh"), shadow.string());
+}
+
+// Test new, removed and non-executable files are noticed
+TEST_F(PathCacheTest, DirectoryChangesInvalidate) {
+    EXPECT_TRUE(cache.Find("cll_cached_tool").empty());
+
+    fs::path program = MakeProgram("cll_cached_tool");
+    EXPECT_EQ(cache.Find("cll_cached_tool"), program.string());
+
+    fs::remove(program);
+    EXPECT_TRUE(cache.Find("cll_cached_tool").empty());
+
+    std::ofstream(binDir / "cll_plain_file") << "data\n";
+    EXPECT_TRUE(cache.Find("cll_plain_file").empty());
+}
+
+// Test PATH changes rebuild the index
+TEST_F(PathCacheTest, PathChangeInvalidates) {
+    MakeProgram("cll_cached_tool");
+    EXPECT_FALSE(cache.Find("cll_cached_tool").empty());
+
+    setenv("PATH", savedPath.c_str(), 1);
+    EXPECT_TRUE(cache.Find("cll_cached_tool").empty());
+    EXPECT_GT(cache.CommandCount(), 0u);
+}
+
+// Test the executor resolves names through the cache
+TEST_F(PathCacheTest, ExecutorUsesCache) {
+    ProcessExecutor executor;
+    executor.SetPathCache(&cache);
+    MakeProgram("cll_cached_tool");
+
+    ProcessRequest request;
+    request.argv = {"cll_cached_tool"};
+    auto result = executor.Execute(request);
+    EXPECT_TRUE(result.success);
+    EXPECT_EQ(result.output, "from cll_cached_tool\n");
+
+    request.argv = {"cll_no_such_program_xyz"};
+    result = executor.Execute(request);
+    EXPECT_EQ(result.exitCode, 127);
+    EXPECT_NE(result.error.find("cll_no_such_program_xyz"), std::string::npos);
+}
+
+// Test unknown commands fail without a shell, and hash -r
+TEST_F(PathCacheTest, ConsoleCommandNotFound) {
+    ClaudeConsole console;
+    ASSERT_TRUE(console.Initialize());
+
+    EXPECT_TRUE(console.IsUnknownCommand("cll_no_such_program_xyz --flag"));
+    EXPECT_FALSE(console.IsUnknownCommand("ls -l"));
+    EXPECT_FALSE(console.IsUnknownCommand("FOO=1 env"));
+    EXPECT_FALSE(console.IsUnknownCommand("cll_no_such_program_xyz | cat"));
+    EXPECT_FALSE(console.IsUnknownCommand("if true; then echo; fi"));
+
+    auto result = console.ExecuteCommand("cll_no_such_program_xyz");
+    EXPECT_FALSE(result.success);
+    EXPECT_EQ(result.exitCode, 127);
+    EXPECT_EQ(result.error, "cll_no_such_program_xyz: command not found");
+    EXPECT_LT(result.executionTime.count(), 100000);
+
+    MakeProgram("cll_cached_tool");
+    result = console.ExecuteCommand("hash -r");
+    EXPECT_TRUE(result.success);
+    EXPECT_EQ(console.ExecuteCommand("cll_cached_tool").output, "from cll_cached_tool\n");
+    EXPECT_EQ(console.ExecuteCommand("which cll_cached_tool").output, (binDir / "cll_cached_tool").string() + "\n");
+
+    result = console.ExecuteCommand("hash cll_no_such_program_xyz");
+    EXPECT_FALSE(result.success);
+    console.Shutdown();
+}
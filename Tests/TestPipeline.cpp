@@ -0,0 +1,104 @@
+#include <gtest/gtest.h>
+#include "ClaudeConsole.h"
+#include "ProcessExecutor.h"
+
+using namespace cll;
+using namespace std::chrono_literals;
+
+class PipelineTest : public ::testing::Test {
+protected:
+    using Stages = std::vector<std::vector<std::string>>;
+
+    ProcessExecutor executor;
+};
+
+// Test lines are split into stages, and what needs the shell is refused
+TEST_F(PipelineTest, SplitPipeline) {
+    Stages stages;
+    ASSERT_TRUE(ClaudeConsole::SplitPipeline("seq 10 | grep '1|2' | wc -l", stages));
+    EXPECT_EQ(stages, (Stages{{"seq", "10"}, {"grep", "1|2"}, {"wc", "-l"}}));
+
+    EXPECT_FALSE(ClaudeConsole::SplitPipeline("ls -l", stages));
+    EXPECT_FALSE(ClaudeConsole::SplitPipeline("a || b", stages));
+    EXPECT_FALSE(ClaudeConsole::SplitPipeline("a | b > out", stages));
+    EXPECT_FALSE(ClaudeConsole::SplitPipeline("a | | b", stages));
+    EXPECT_FALSE(ClaudeConsole::SplitPipeline("a |", stages));
+    EXPECT_FALSE(ClaudeConsole::SplitPipeline("a | b $HOME", stages));
+}
+
+// Test data flows through every stage and each one is accounted for
+TEST_F(PipelineTest, RunsStagesWithStats) {
+    auto result = executor.ExecutePipeline({{"seq", "1", "10000"}, {"grep", "7"}, {"wc", "-l"}}, {});
+    EXPECT_TRUE(result.success);
+    EXPECT_EQ(result.output, "3439\n");
+    ASSERT_EQ(result.stages.size(), 3u);
+    EXPECT_EQ(result.stages[0].command, "seq 1 10000");
+    EXPECT_EQ(result.stages[0].bytesOut, 48894u);
+    EXPECT_EQ(result.stages[2].bytesOut, 5u);
+    for (const auto& stage : result.stages) {
+        EXPECT_EQ(stage.exitCode, 0);
+        EXPECT_GT(stage.wallTime.count(), 0);
+        EXPECT_LE(stage.wallTime, result.executionTime);
+    }
+}
+
+// Test stderr is shared, exit codes are per stage and the last one wins
+TEST_F(PipelineTest, ExitCodesAndStderr) {
+    auto result = executor.ExecutePipeline({{"sh", "-c", "echo oops >&2; exit 3"}, {"cat"}}, {});
+    EXPECT_TRUE(result.success);
+    EXPECT_EQ(result.error, "oops\n");
+    EXPECT_EQ(result.stages[0].exitCode, 3);
+
+    result = executor.ExecutePipeline({{"echo", "x"}, {"sh", "-c", "cat; exit 4"}}, {});
+    EXPECT_FALSE(result.success);
+    EXPECT_EQ(result.exitCode, 4);
+    EXPECT_EQ(result.output, "x\n");
+}
+
+// Test a stage that cannot start does not stop the others
+TEST_F(PipelineTest, MissingStage) {
+    auto result = executor.ExecutePipeline({{"cll_no_such_program_xyz"}, {"wc", "-c"}}, {});
+    EXPECT_EQ(result.stages[0].exitCode, 127);
+    EXPECT_NE(result.error.find("cll_no_such_program_xyz"), std::string::npos);
+    EXPECT_NE(result.output.find('0'), std::string::npos);
+}
+
+// Test an early reader exit ends an endless writer
+TEST_F(PipelineTest, DownstreamExitStopsUpstream) {
+    auto start = std::chrono::steady_clock::now();
+    auto result = executor.ExecutePipeline({{"yes"}, {"head", "-n", "3"}}, {});
+    EXPECT_LT(std::chrono::steady_clock::now() - start, 5s);
+    EXPECT_EQ(result.output, "y\ny\ny\n");
+    EXPECT_EQ(result.exitCode, 0);
+    EXPECT_EQ(result.stages[0].exitCode, 128 + SIGPIPE);
+}
+
+// Test a timeout stops every stage
+TEST_F(PipelineTest, TimeoutStopsAllStages) {
+    ProcessRequest options;
+    options.timeout = 200ms;
+    auto result = executor.ExecutePipeline({{"sleep", "30"}, {"cat"}}, options);
+    EXPECT_TRUE(result.timedOut);
+    EXPECT_EQ(result.stages[0].exitCode, 128 + SIGTERM);
+}
+
+// Test the console runs simple pipelines natively and formats the breakdown
+TEST_F(PipelineTest, ConsoleUsesNativePipeline) {
+    ClaudeConsole console;
+    ASSERT_TRUE(console.Initialize());
+
+    auto result = console.ExecuteCommand("seq 5 | tail -n 2");
+    EXPECT_EQ(result.output, "4\n5\n");
+    ASSERT_EQ(result.stages.size(), 2u);
+    std::string timing = ClaudeConsole::FormatExecutionTime(result);
+    EXPECT_NE(timing.find(": seq 5 ["), std::string::npos);
+    EXPECT_NE(timing.find(" | tail -n 2 ["), std::string::npos);
+
+    // Shell syntax and builtins still go through /bin/sh
+    result = console.ExecuteCommand("seq 3 | tail -n 1 > /dev/null || echo no");
+    EXPECT_TRUE(result.stages.empty());
+    result = console.ExecuteCommand("echo hi | cat");
+    EXPECT_EQ(result.output, "hi\n");
+    EXPECT_TRUE(result.stages.empty());
+    console.Shutdown();
+}
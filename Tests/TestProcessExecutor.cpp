@@ -0,0 +1,108 @@
+#include <gtest/gtest.h>
+#include "ProcessExecutor.h"
+#include <filesystem>
+#include <fstream>
+#include <unistd.h>
+
+using namespace cll;
+
+class ProcessExecutorTest : public ::testing::Test {
+protected:
+    ProcessExecutor executor;
+};
+
+// Test stdout and stderr are captured separately
+TEST_F(ProcessExecutorTest, SeparateStdoutAndStderr) {
+    auto result = executor.ExecuteShell("echo out; echo err >&2");
+    EXPECT_TRUE(result.success);
+    EXPECT_EQ(result.exitCode, 0);
+    EXPECT_EQ(result.output, "out\n");
+    EXPECT_EQ(result.error, "err\n");
+    EXPECT_GT(result.executionTime.count(), 0);
+}
+
+// Test merged stderr behaves like 2>&1
+TEST_F(ProcessExecutorTest, MergedStderr) {
+    auto request = ProcessRequest::Shell("echo out; echo err >&2");
+    request.mergeStderr = true;
+    auto result = executor.Execute(request);
+    EXPECT_TRUE(result.success);
+    EXPECT_EQ(result.output, "out\nerr\n");
+    EXPECT_TRUE(result.error.empty());
+}
+
+// Test capture keeps embedded NUL bytes
+TEST_F(ProcessExecutorTest, BinarySafeCapture) {
+    auto result = executor.ExecuteShell("printf 'a\\000b\\000c'");
+    EXPECT_TRUE(result.success);
+    ASSERT_EQ(result.output.size(), 5u);
+    EXPECT_EQ(result.output, std::string("a\0b\0c", 5));
+}
+
+// Test bulk binary output is captured byte for byte, streamed or not
+TEST_F(ProcessExecutorTest, BulkBinaryCapture) {
+    std::string path = std::filesystem::temp_directory_path() / ("cll_capture_" + std::to_string(getpid()));
+    std::string data(24 << 20, '\0');
+    for (size_t i = 0; i < data.size(); ++i) {
+        data[i] = static_cast<char>((i * 2654435761u) >> 13);
+    }
+    std::ofstream(path, std::ios::binary).write(data.data(), static_cast<std::streamsize>(data.size()));
+
+    auto result = executor.ExecuteShell("cat " + path);
+    EXPECT_TRUE(result.output == data);
+
+    std::string streamed;
+    auto request = ProcessRequest::Shell("cat " + path);
+    request.onStdout = [&](std::string_view chunk) { streamed.append(chunk); };
+    executor.Execute(request);
+    EXPECT_TRUE(streamed == data);
+    std::filesystem::remove(path);
+}
+
+// Test exit codes, including death by signal
+TEST_F(ProcessExecutorTest, ExitCodes) {
+    auto result = executor.ExecuteShell("exit 3");
+    EXPECT_FALSE(result.success);
+    EXPECT_EQ(result.exitCode, 3);
+    
+    result = executor.ExecuteShell("kill -TERM $$");
+    EXPECT_FALSE(result.success);
+    EXPECT_EQ(result.exitCode, 128 + 15);
+}
+
+// Test argv requests run the program directly
+TEST_F(ProcessExecutorTest, DirectArgv) {
+    ProcessRequest request;
+    request.argv = {"printf", "%s|%s", "a b", "$HOME"};
+    auto result = executor.Execute(request);
+    EXPECT_TRUE(result.success);
+    EXPECT_EQ(result.output, "a b|$HOME");
+}
+
+// Test programs that cannot be started report 127
+TEST_F(ProcessExecutorTest, SpawnFailure) {
+    ProcessRequest request;
+    request.argv = {"/nonexistent/program_12345"};
+    auto result = executor.Execute(request);
+    EXPECT_FALSE(result.success);
+    EXPECT_EQ(result.exitCode, 127);
+    EXPECT_FALSE(result.error.empty());
+    
+    result = executor.Execute(ProcessRequest{});
+    EXPECT_EQ(result.exitCode, 127);
+}
+
+// Test large outputs arrive intact through the streaming sinks
+TEST_F(ProcessExecutorTest, StreamingSinks) {
+    size_t outBytes = 0;
+    std::string err;
+    auto request = ProcessRequest::Shell("head -c 1000000 /dev/zero; echo done >&2");
+    request.onStdout = [&](std::string_view chunk) { outBytes += chunk.size(); };
+    request.onStderr = [&](std::string_view chunk) { err.append(chunk); };
+    auto result = executor.Execute(request);
+    EXPECT_TRUE(result.success);
+    EXPECT_EQ(outBytes, 1000000u);
+    EXPECT_EQ(err, "done\n");
+    EXPECT_TRUE(result.output.empty());
+    EXPECT_TRUE(result.error.empty());
+}
@@ -0,0 +1,206 @@
+#include <gtest/gtest.h>
+#include "ClaudeConsole.h"
+#include "ProcessExecutor.h"
+#include <algorithm>
+#include <fstream>
+#include <thread>
+
+using namespace cll;
+
+namespace {
+
+// The Cpus_allowed_list line of a process's status, "0-3" and the like
+std::string AllowedCpus(const std::string& status) {
+    size_t line = status.find("Cpus_allowed_list:");
+    if (line == std::string::npos) return "";
+    size_t start = status.find_first_not_of(" \t", status.find(':', line) + 1);
+    return status.substr(start, status.find('\n', start) - start);
+}
+
+std::string OwnAllowedCpus() {
+    std::ifstream file("/proc/self/status");
+    return AllowedCpus(std::string(std::istreambuf_iterator<char>(file), {}));
+}
+
+} // namespace
+
+// Limits run each test locally and through the spawn server, which apply
+// them on different code paths
+class ProcessLimitsTest : public ::testing::TestWithParam<bool> {
+protected:
+    void SetUp() override {
+        if (GetParam()) {
+            ASSERT_TRUE(executor.StartServer());
+        }
+    }
+
+    CommandResult Run(const std::string& command, const ProcessLimits& limits) {
+        ProcessRequest request = ProcessRequest::Shell(command);
+        request.limits = limits;
+        return executor.Execute(request);
+    }
+
+    ProcessExecutor executor;
+};
+
+INSTANTIATE_TEST_SUITE_P(SpawnPaths, ProcessLimitsTest, ::testing::Values(false, true),
+                         [](const auto& info) { return info.param ? "Server" : "Local"; });
+
+// Test nice is added to the inherited niceness
+TEST_P(ProcessLimitsTest, AppliesNice) {
+    ProcessLimits limits;
+    limits.nice = 5;
+    int expected = std::min(getpriority(PRIO_PROCESS, 0) + 5, 19);
+    auto result = Run("nice", limits);
+    EXPECT_EQ(result.exitCode, 0) << result.error;
+    EXPECT_EQ(result.output, std::to_string(expected) + "\n");
+}
+
+// Test RLIMIT_AS and RLIMIT_CPU are in place when the program starts
+TEST_P(ProcessLimitsTest, AppliesResourceLimits) {
+    ProcessLimits limits;
+    limits.addressSpace = 256 << 20;
+    limits.cpuSeconds = 7;
+    auto result = Run("ulimit -v; ulimit -t", limits);
+    EXPECT_EQ(result.exitCode, 0) << result.error;
+    EXPECT_EQ(result.output, "262144\n7\n");
+}
+
+// Test the affinity mask reaches the child
+TEST_P(ProcessLimitsTest, AppliesAffinity) {
+    ProcessLimits limits;
+    cpu_set_t cpus;
+    ASSERT_TRUE(ProcessLimits::ParseCpuList("0", cpus));
+    limits.cpus = cpus;
+    auto result = Run("cat /proc/self/status", limits);
+    EXPECT_EQ(result.exitCode, 0) << result.error;
+    EXPECT_EQ(AllowedCpus(result.output), "0");
+}
+
+// Test a cgroup that cannot be joined is reported but not fatal
+TEST_P(ProcessLimitsTest, CgroupIsBestEffort) {
+    ProcessLimits limits;
+    limits.cgroup = "/nonexistent/cll-test";
+    auto result = Run("echo ran", limits);
+    EXPECT_EQ(result.exitCode, 0);
+    EXPECT_EQ(result.output, "ran\n");
+    EXPECT_NE(result.error.find("cll: /nonexistent/cll-test:"), std::string::npos);
+}
+
+// Test a pipeline applies its limits to every stage
+TEST_P(ProcessLimitsTest, PipelineStagesShareLimits) {
+    ProcessRequest options;
+    options.limits.cpuSeconds = 9;
+    auto result = executor.ExecutePipeline({{"sh", "-c", "ulimit -t"}, {"sh", "-c", "cat; ulimit -t"}}, options);
+    EXPECT_EQ(result.output, "9\n9\n");
+}
+
+// Test options parse, and Describe() gives them back
+TEST(ProcessLimitsParse, ParsesOptions) {
+    ProcessLimits limits;
+    std::string error;
+    for (const char* option : {"nice=+5", "cpus=0-2,5", "mem=512M", "cputime=30", "cgroup=build"}) {
+        EXPECT_TRUE(limits.ParseOption(option, error)) << option << ": " << error;
+    }
+    EXPECT_EQ(limits.nice, 5);
+    ASSERT_TRUE(limits.cpus);
+    EXPECT_EQ(CPU_COUNT(&*limits.cpus), 4);
+    EXPECT_EQ(limits.addressSpace, rlim_t(512) << 20);
+    EXPECT_EQ(limits.cpuSeconds, 30u);
+    EXPECT_EQ(limits.cgroup, "/sys/fs/cgroup/build");
+    EXPECT_EQ(limits.Describe(), "nice=5 cpus=0-2,5 mem=512M cputime=30 cgroup=/sys/fs/cgroup/build");
+    EXPECT_FALSE(limits.Empty());
+    EXPECT_TRUE(ProcessLimits{}.Empty());
+}
+
+// Test malformed options are rejected with a message
+TEST(ProcessLimitsParse, RejectsBadOptions) {
+    for (const char* option : {"nice", "nice=", "nice=x", "cpus=3-1", "cpus=0,", "cpus=a",
+                               "mem=12Q", "mem=0", "cputime=-1", "bogus=1"}) {
+        ProcessLimits limits;
+        std::string error;
+        EXPECT_FALSE(limits.ParseOption(option, error)) << option;
+        EXPECT_FALSE(error.empty()) << option;
+    }
+}
+
+// Test the limit prefix is split from the command, quoting intact
+TEST(ProcessLimitsParse, SplitsLimitPrefix) {
+    ProcessLimits limits;
+    std::string rest, error;
+    EXPECT_TRUE(ClaudeConsole::SplitLimitPrefix("limit nice=3 mem=1G -- echo 'a  b'", limits, rest, error));
+    EXPECT_TRUE(error.empty());
+    EXPECT_EQ(rest, "echo 'a  b'");
+    EXPECT_EQ(limits.nice, 3);
+    EXPECT_EQ(limits.addressSpace, rlim_t(1) << 30);
+
+    // Without "--" the command starts at the first word without '='
+    limits = {};
+    EXPECT_TRUE(ClaudeConsole::SplitLimitPrefix("  limit cputime=5 make -j4", limits, rest, error));
+    EXPECT_EQ(rest, "make -j4");
+    EXPECT_EQ(limits.cpuSeconds, 5u);
+
+    EXPECT_FALSE(ClaudeConsole::SplitLimitPrefix("limitless", limits, rest, error));
+    EXPECT_FALSE(ClaudeConsole::SplitLimitPrefix("echo limit", limits, rest, error));
+
+    EXPECT_TRUE(ClaudeConsole::SplitLimitPrefix("limit nice=3 --", limits, rest, error));
+    EXPECT_EQ(error, "limit: missing command");
+    error.clear();
+    EXPECT_TRUE(ClaudeConsole::SplitLimitPrefix("limit size=3 ls", limits, rest, error));
+    EXPECT_NE(error.find("unknown option"), std::string::npos);
+}
+
+// Test the console runs prefixed commands, and JavaScript-style explicit limits, under them
+TEST(ProcessLimitsConsole, RunsLimitedCommands) {
+    ClaudeConsole console;
+    int expected = std::min(getpriority(PRIO_PROCESS, 0) + 4, 19);
+
+    auto result = console.CaptureShellCommand("limit nice=4 -- nice");
+    EXPECT_EQ(result.exitCode, 0) << result.error;
+    EXPECT_EQ(result.output, std::to_string(expected) + "\n");
+
+    ProcessLimits limits;
+    limits.cpuSeconds = 11;
+    result = console.CaptureShellCommand("ulimit -t", std::nullopt, &limits);
+    EXPECT_EQ(result.output, "11\n");
+
+    // Configured limits apply to every command; the prefix adds to them
+    console.SetCommandLimits(limits);
+    result = console.CaptureShellCommand("limit mem=128M -- sh -c 'ulimit -t; ulimit -v'");
+    EXPECT_EQ(result.output, "11\n131072\n");
+    console.SetCommandLimits({});
+
+    // Substitutions are spawned commands too
+    console.SetCommandLimits(limits);
+    EXPECT_EQ(console.ExecuteCommand("echo $(ulimit -t)").output, "11\n");
+    console.SetCommandLimits({});
+
+    result = console.CaptureShellCommand("limit mem=lots ls");
+    EXPECT_FALSE(result.success);
+    EXPECT_EQ(result.exitCode, 2);
+    EXPECT_NE(result.error.find("limit: bad value for mem"), std::string::npos);
+}
+
+// Test commands do not inherit the REPL thread's CPUs
+TEST(ProcessLimitsConsole, CommandsKeepProcessCpus) {
+    std::string original = OwnAllowedCpus();
+    std::string childCpus, substitutionCpus, replCpus;
+    // A thread of its own, so pinning it leaves the test runner alone
+    std::thread repl([&] {
+        ClaudeConsole console;
+        cpu_set_t cpus;
+        ASSERT_TRUE(ProcessLimits::ParseCpuList("0", cpus));
+        ASSERT_TRUE(console.SetReplCpus(cpus));
+        replCpus = AllowedCpus([] {
+            std::ifstream file("/proc/thread-self/status");
+            return std::string(std::istreambuf_iterator<char>(file), {});
+        }());
+        childCpus = AllowedCpus(console.CaptureShellCommand("cat /proc/self/status").output);
+        substitutionCpus = AllowedCpus(
+            console.ExecuteCommand("echo \"$(grep Cpus_allowed_list /proc/self/status)\"").output);
+    });
+    repl.join();
+    EXPECT_EQ(replCpus, "0");
+    EXPECT_EQ(childCpus, original);
+    EXPECT_EQ(substitutionCpus, original);
+}
@@ -0,0 +1,54 @@
+#include <gtest/gtest.h>
+#include "ClaudeConsole.h"
+#include "ProcessExecutor.h"
+
+using namespace cll;
+
+class ResourceUsageTest : public ::testing::Test {
+protected:
+    ProcessExecutor executor;
+};
+
+// Test a child's CPU time, peak memory and switches are collected
+TEST_F(ResourceUsageTest, CollectsChildUsage) {
+    auto result = executor.ExecuteShell(
+        "i=0; while [ $i -lt 200000 ]; do i=$((i+1)); done; dd if=/dev/zero of=/dev/null bs=32M count=1 2>/dev/null");
+    EXPECT_TRUE(result.success);
+    ASSERT_TRUE(result.usage.measured);
+    EXPECT_GT((result.usage.userTime + result.usage.systemTime).count(), 0);
+    // dd's 32 MB buffer is the largest of the lot
+    EXPECT_GE(result.usage.maxRssKb, 32 * 1024);
+    EXPECT_GT(result.usage.voluntarySwitches + result.usage.involuntarySwitches, 0);
+}
+
+// Test a pipeline's usage covers every stage
+TEST_F(ResourceUsageTest, PipelineSumsStages) {
+    auto result = executor.ExecutePipeline(
+        {{"dd", "if=/dev/zero", "bs=16M", "count=4"}, {"wc", "-c"}}, {});
+    EXPECT_EQ(result.output, "67108864\n");
+    ASSERT_TRUE(result.usage.measured);
+    std::chrono::microseconds cpu{0};
+    for (const auto& stage : result.stages) {
+        cpu += stage.cpuTime;
+    }
+    EXPECT_EQ(result.usage.userTime + result.usage.systemTime, cpu);
+    EXPECT_GE(result.usage.maxRssKb, 16 * 1024);
+}
+
+// Test the console keeps the last command's usage and shows it in the timing
+TEST_F(ResourceUsageTest, ConsoleReportsUsage) {
+    ClaudeConsole console;
+    ASSERT_TRUE(console.Initialize());
+
+    auto result = console.ExecuteCommand("ls /");
+    EXPECT_TRUE(console.GetLastUsage().measured);
+    std::string timing = ClaudeConsole::FormatExecutionTime(result);
+    EXPECT_NE(timing.find(", user "), std::string::npos);
+    EXPECT_NE(timing.find(", rss "), std::string::npos);
+
+    // Builtins run in-process, so there is no child to account for
+    result = console.ExecuteCommand("pwd");
+    EXPECT_FALSE(console.GetLastUsage().measured);
+    EXPECT_EQ(ClaudeConsole::FormatExecutionTime(result).find("user"), std::string::npos);
+    console.Shutdown();
+}
@@ -0,0 +1,102 @@
+#include <gtest/gtest.h>
+#include "ScriptSource.h"
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+#include <unistd.h>
+
+using namespace cll;
+namespace fs = std::filesystem;
+
+class ScriptSourceTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        path = fs::temp_directory_path() / ("cll_script_source_" + std::to_string(getpid()) + ".js");
+    }
+
+    void TearDown() override {
+        fs::remove(path);
+    }
+
+    std::shared_ptr<const ScriptSource> Open(const std::string& text) {
+        std::ofstream(path, std::ios::binary | std::ios::trunc) << text;
+        std::string error;
+        auto source = ScriptSource::Open(path.string(), error);
+        EXPECT_TRUE(source) << error;
+        return source;
+    }
+
+    fs::path path;
+};
+
+// Test ASCII is handed over as read, with nothing decoded alongside
+TEST_F(ScriptSourceTest, AsciiIsUsedAsRead) {
+    auto source = Open("var answer = 42; // plain\n");
+    ASSERT_TRUE(source);
+    EXPECT_TRUE(source->IsAscii());
+    EXPECT_EQ(source->GetEncoding(), ScriptSource::Encoding::Latin1);
+    EXPECT_EQ(source->Latin1().data(), source->Bytes().data());
+    EXPECT_EQ(source->Latin1(), "var answer = 42; // plain\n");
+}
+
+// Test UTF-8 within Latin-1 narrows to one byte per character
+TEST_F(ScriptSourceTest, Latin1FromUtf8) {
+    auto source = Open("print('caf\xC3\xA9 \xC2\xA3')");
+    ASSERT_TRUE(source);
+    EXPECT_FALSE(source->IsAscii());
+    EXPECT_EQ(source->GetEncoding(), ScriptSource::Encoding::Latin1);
+    EXPECT_EQ(source->Latin1(), "print('caf\xE9 \xA3')");
+}
+
+// Test characters past U+00FF, including astral ones, decode to UTF-16
+TEST_F(ScriptSourceTest, Utf16FromUtf8) {
+    auto source = Open("'\xE2\x82\xAC\xF0\x9F\x98\x80'");
+    ASSERT_TRUE(source);
+    EXPECT_EQ(source->GetEncoding(), ScriptSource::Encoding::Utf16);
+    EXPECT_EQ(source->Utf16(), u"'€\U0001F600'");
+}
+
+// Test malformed UTF-8 is left for V8 to decode
+TEST_F(ScriptSourceTest, RejectsMalformedUtf8) {
+    std::string latin1;
+    std::u16string utf16;
+    for (const char* text : {"\xC3", "\xC0\xAF", "\xED\xA0\x80", "\xF4\x90\x80\x80", "\xFF", "a\x80"}) {
+        EXPECT_EQ(ScriptSource::Decode(text, latin1, utf16), ScriptSource::Encoding::Invalid) << text;
+    }
+    auto source = Open("x = '\xC3('");
+    ASSERT_TRUE(source);
+    EXPECT_EQ(source->GetEncoding(), ScriptSource::Encoding::Invalid);
+    EXPECT_EQ(source->Bytes(), "x = '\xC3('");
+}
+
+// Test the word-at-a-time ASCII scan finds a high byte anywhere
+TEST_F(ScriptSourceTest, AsciiScan) {
+    std::string text(37, 'a');
+    EXPECT_TRUE(ScriptSource::IsAsciiText(text));
+    for (size_t i = 0; i < text.size(); ++i) {
+        std::string marked = text;
+        marked[i] = '\xC3';
+        EXPECT_FALSE(ScriptSource::IsAsciiText(marked)) << i;
+    }
+    EXPECT_TRUE(ScriptSource::IsAsciiText(""));
+}
+
+// Test a buffer read elsewhere, as by the streaming compiler, is taken over in place
+TEST_F(ScriptSourceTest, FromBuffer) {
+    std::string text = "print('caf\xC3\xA9') // past the end";
+    auto bytes = std::make_unique<char[]>(text.size());
+    std::copy(text.begin(), text.end(), bytes.get());
+    const char* data = bytes.get();
+    auto source = ScriptSource::FromBuffer(std::move(bytes), 14);
+    EXPECT_EQ(source->Bytes().data(), data);
+    EXPECT_EQ(source->Bytes(), "print('caf\xC3\xA9')");
+    EXPECT_EQ(source->GetEncoding(), ScriptSource::Encoding::Latin1);
+    EXPECT_EQ(source->Latin1(), "print('caf\xE9')");
+}
+
+// Test a missing file reports why
+TEST_F(ScriptSourceTest, MissingFile) {
+    std::string error;
+    EXPECT_FALSE(ScriptSource::Open((fs::temp_directory_path() / "cll_no_such_script.js").string(), error));
+    EXPECT_NE(error.find("No such file"), std::string::npos);
+}
@@ -0,0 +1,117 @@
+#include <gtest/gtest.h>
+#include "ShellSession.h"
+#include "ClaudeConsole.h"
+
+using namespace cll;
+
+class ShellSessionTest : public ::testing::Test {
+protected:
+    ProcessExecutor executor;
+    ShellSession session{executor};
+};
+
+// Test output and exit status are framed per command
+TEST_F(ShellSessionTest, OutputAndExitCode) {
+    auto result = session.Execute("echo hello; echo oops >&2");
+    EXPECT_TRUE(result.success);
+    EXPECT_EQ(result.output, "hello\n");
+    EXPECT_EQ(result.error, "oops\n");
+    
+    result = session.Execute("false");
+    EXPECT_FALSE(result.success);
+    EXPECT_EQ(result.exitCode, 1);
+    
+    // Output without a trailing newline is kept exactly
+    result = session.Execute("printf abc");
+    EXPECT_EQ(result.output, "abc");
+    EXPECT_TRUE(session.IsRunning());
+}
+
+// Test shell state persists between commands
+TEST_F(ShellSessionTest, StatePersists) {
+    session.Execute("cd /tmp");
+    EXPECT_EQ(session.Execute("pwd").output, "/tmp\n");
+    
+    session.Execute("export CLL_SESSION_TEST=42");
+    EXPECT_EQ(session.Execute("echo $CLL_SESSION_TEST").output, "42\n");
+    
+    session.Execute("greet() { echo \"hi $1\"; }");
+    EXPECT_EQ(session.Execute("greet there").output, "hi there\n");
+}
+
+// Test quoting and syntax errors do not break the framing
+TEST_F(ShellSessionTest, QuotingAndSyntaxErrors) {
+    auto result = session.Execute("echo 'it'\"'\"'s'");
+    EXPECT_EQ(result.output, "it's\n");
+    
+    result = session.Execute("echo \"unterminated");
+    EXPECT_FALSE(result.success);
+    EXPECT_FALSE(result.error.empty());
+    
+    result = session.Execute("echo still alive");
+    EXPECT_EQ(result.output, "still alive\n");
+}
+
+// Test exiting the shell reports its status and the session restarts
+TEST_F(ShellSessionTest, ExitRestartsSession) {
+    session.Execute("cd /tmp");
+    auto result = session.Execute("echo bye; exit 3");
+    EXPECT_EQ(result.output, "bye\n");
+    EXPECT_EQ(result.exitCode, 3);
+    EXPECT_FALSE(session.IsRunning());
+    
+    result = session.Execute("echo back");
+    EXPECT_EQ(result.output, "back\n");
+    EXPECT_TRUE(session.IsRunning());
+}
+
+// Test large output is delivered intact through the sinks
+TEST_F(ShellSessionTest, StreamingLargeOutput) {
+    size_t bytes = 0;
+    auto result = session.Execute("head -c 500000 /dev/zero",
+        [&](std::string_view chunk) { bytes += chunk.size(); });
+    EXPECT_TRUE(result.success);
+    EXPECT_EQ(bytes, 500000u);
+}
+
+// Test ClaudeConsole routes Shell mode through the session when enabled
+TEST_F(ShellSessionTest, ConsolePersistentShell) {
+    ClaudeConsole console;
+    ASSERT_TRUE(console.Initialize());
+    console.SetPersistentShell(true);
+    EXPECT_TRUE(console.IsPersistentShell());
+    
+    console.ExecuteCommand("CLL_VAR=kept");
+    auto result = console.ExecuteCommand("echo $CLL_VAR");
+    EXPECT_EQ(result.output, "kept\n");
+    
+    console.SetPersistentShell(false);
+    result = console.ExecuteCommand("echo $CLL_VAR");
+    EXPECT_EQ(result.output, "\n");
+    console.Shutdown();
+}
+
+// Test lines the session cannot run are refused rather than run elsewhere
+TEST_F(ShellSessionTest, ConsoleRefusesWhatSessionCannotRun) {
+    ClaudeConsole console;
+    ASSERT_TRUE(console.Initialize());
+    console.SetPersistentShell(true);
+    console.ExecuteCommand("cd /usr");
+    
+    auto result = console.ExecuteCommand("pwd &");
+    EXPECT_FALSE(result.success);
+    EXPECT_NE(result.error.find("Background jobs"), std::string::npos);
+    EXPECT_TRUE(console.ExecuteCommand("jobs").output.empty());
+    
+    console.ExecuteCommand("echo fed");
+    result = console.ExecuteCommand("cat <<< $_");
+    EXPECT_FALSE(result.success);
+    EXPECT_NE(result.error.find("Stdin feeds"), std::string::npos);
+    
+    result = console.ExecuteCommand("limit nice=5 -- pwd");
+    EXPECT_FALSE(result.success);
+    EXPECT_NE(result.error.find("Per-command limits"), std::string::npos);
+    
+    EXPECT_EQ(console.ExecuteCommand("pwd").output, "/usr\n");
+    console.Shutdown();
+}
@@ -0,0 +1,98 @@
+#include <gtest/gtest.h>
+#include "ClaudeConsole.h"
+#include "SourceManifest.h"
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <unistd.h>
+
+using namespace cll;
+namespace fs = std::filesystem;
+
+class SourceManifestTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        dir = fs::temp_directory_path() / ("cll_manifest_" + std::to_string(getpid()));
+        fs::create_directories(dir);
+    }
+
+    void TearDown() override {
+        fs::remove_all(dir);
+    }
+
+    std::string WriteFile(const std::string& name, const std::string& text) {
+        fs::path path = dir / name;
+        std::ofstream(path, std::ios::binary | std::ios::trunc) << text;
+        return path.string();
+    }
+
+    fs::path dir;
+};
+
+// Test the hash is FNV-1a, so caches written by one build are read by the next
+TEST_F(SourceManifestTest, HashIsStable) {
+    EXPECT_EQ(SourceManifest::Hash(""), 0xcbf29ce484222325ull);
+    EXPECT_EQ(SourceManifest::Hash("a"), 0xaf63dc4c8601ec8cull);
+    EXPECT_NE(SourceManifest::Hash("init.js"), SourceManifest::Hash("init.jS"));
+    EXPECT_EQ(SourceManifest::HashFile(WriteFile("a.js", "a")), SourceManifest::Hash("a"));
+    EXPECT_FALSE(SourceManifest::HashFile((dir / "missing.js").string()));
+}
+
+// Test a change to any recorded file is noticed, and a restore undoes it
+TEST_F(SourceManifestTest, NoticesChangedFiles) {
+    std::string init = WriteFile("init.js", "load('lib.js');\n");
+    std::string lib = WriteFile("lib.js", "var x = 1;\n");
+    SourceManifest sources;
+    EXPECT_TRUE(sources.Add(init));
+    EXPECT_TRUE(sources.Add(lib));
+    EXPECT_TRUE(sources.Add(lib));
+    EXPECT_FALSE(sources.Add((dir / "missing.js").string()));
+    EXPECT_EQ(sources.Entries().size(), 2u);
+    EXPECT_TRUE(sources.IsCurrent());
+
+    WriteFile("lib.js", "var x = 2;\n");
+    EXPECT_FALSE(sources.IsCurrent());
+    WriteFile("lib.js", "var x = 1;\n");
+    EXPECT_TRUE(sources.IsCurrent());
+
+    fs::remove(lib);
+    EXPECT_FALSE(sources.IsCurrent());
+}
+
+// Test a manifest reads back under its key and leaves the stream at what follows
+TEST_F(SourceManifestTest, RoundTripsAheadOfData) {
+    SourceManifest sources;
+    ASSERT_TRUE(sources.Add(WriteFile("init.js", "print(1)\n")));
+    std::stringstream stream;
+    sources.Write(stream, "cll-init-snapshot 12.4");
+    stream << "BLOB";
+
+    SourceManifest read;
+    ASSERT_TRUE(read.Read(stream, "cll-init-snapshot 12.4"));
+    ASSERT_EQ(read.Entries().size(), 1u);
+    EXPECT_EQ(read.Entries()[0].path, sources.Entries()[0].path);
+    EXPECT_EQ(read.Entries()[0].hash, sources.Entries()[0].hash);
+    EXPECT_TRUE(read.IsCurrent());
+    EXPECT_EQ(std::string(std::istreambuf_iterator<char>(stream), {}), "BLOB");
+
+    // Another V8 version, or a damaged file, is refused
+    stream.clear();
+    stream.seekg(0);
+    EXPECT_FALSE(read.Read(stream, "cll-init-snapshot 12.5"));
+    std::stringstream damaged("cll-init-snapshot 12.4\n2\n0123 short\n");
+    EXPECT_FALSE(read.Read(damaged, "cll-init-snapshot 12.4"));
+    EXPECT_TRUE(read.Entries().empty());
+}
+
+// Test init.js and its cache live in the config directory
+TEST(InitSnapshot, PathsAreUnderConfig) {
+    ClaudeConsole console;
+    EXPECT_EQ(console.InitScriptPath(), console.GetConfigPath() + "/init.js");
+    EXPECT_EQ(console.InitSnapshotPath(), console.GetConfigPath() + "/cache/init.snapshot");
+    EXPECT_TRUE(console.GetInitSnapshot());
+    if (!console.EnsureJavaScript()) {
+        std::string error;
+        EXPECT_FALSE(console.WriteInitSnapshot(console.InitSnapshotPath(), error));
+        EXPECT_FALSE(error.empty());
+    }
+}
@@ -0,0 +1,98 @@
+#include <gtest/gtest.h>
+#include "ProcessExecutor.h"
+#include "SpawnServer.h"
+#include "ShellSession.h"
+#include <cstdlib>
+#include <filesystem>
+
+using namespace cll;
+
+class SpawnServerTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        ASSERT_TRUE(executor.StartServer());
+        ASSERT_TRUE(executor.UsesServer());
+    }
+
+    ProcessExecutor executor;
+};
+
+// Test output, stderr and exit codes come back through the server
+TEST_F(SpawnServerTest, ExecuteThroughServer) {
+    auto result = executor.ExecuteShell("echo out; echo err >&2; exit 4");
+    EXPECT_FALSE(result.success);
+    EXPECT_EQ(result.exitCode, 4);
+    EXPECT_EQ(result.output, "out\n");
+    EXPECT_EQ(result.error, "err\n");
+
+    result = executor.ExecuteShell("kill -TERM $$");
+    EXPECT_EQ(result.exitCode, 128 + 15);
+}
+
+// Test children are not started by this process
+TEST_F(SpawnServerTest, ChildIsNotOurs) {
+    auto result = executor.ExecuteShell("echo $PPID");
+    ASSERT_TRUE(result.success);
+    EXPECT_NE(std::atoi(result.output.c_str()), getpid());
+}
+
+// Test the current directory and environment follow the console
+TEST_F(SpawnServerTest, InheritsCwdAndEnvironment) {
+    auto saved = std::filesystem::current_path();
+    std::filesystem::current_path("/tmp");
+    setenv("CLL_SPAWN_TEST", "fresh", 1);
+
+    auto result = executor.ExecuteShell("pwd; echo $CLL_SPAWN_TEST");
+    EXPECT_EQ(result.output, "/tmp\nfresh\n");
+
+    unsetenv("CLL_SPAWN_TEST");
+    std::filesystem::current_path(saved);
+}
+
+// Test a missing program exits 127 with a message
+TEST_F(SpawnServerTest, MissingProgram) {
+    ProcessRequest request;
+    request.argv = {"cll_no_such_program_xyz"};
+    auto result = executor.Execute(request);
+    EXPECT_FALSE(result.success);
+    EXPECT_EQ(result.exitCode, 127);
+    EXPECT_NE(result.error.find("cll_no_such_program_xyz"), std::string::npos);
+}
+
+// Test piped stdin and interleaved waits, as used by the shell session
+TEST_F(SpawnServerTest, ShellSessionThroughServer) {
+    ShellSession session(executor);
+    auto result = session.Execute("X=1");
+    EXPECT_TRUE(result.success);
+    result = session.Execute("echo $X");
+    EXPECT_EQ(result.output, "1\n");
+
+    result = executor.ExecuteShell("echo between");
+    EXPECT_EQ(result.output, "between\n");
+
+    result = session.Execute("exit 2");
+    EXPECT_EQ(result.exitCode, 2);
+}
+
+// Test spawning falls back to posix_spawn once the server is stopped
+TEST_F(SpawnServerTest, FallbackWhenStopped) {
+    executor.StopServer();
+    EXPECT_FALSE(executor.UsesServer());
+
+    auto result = executor.ExecuteShell("echo local");
+    EXPECT_TRUE(result.success);
+    EXPECT_EQ(result.output, "local\n");
+}
+
+// Test oversized requests fall back to a local spawn
+TEST_F(SpawnServerTest, OversizedRequestFallsBack) {
+    ProcessRequest request;
+    request.argv = {"/bin/sh", "-c", "echo $#", "sh"};
+    for (int i = 0; i < 4; ++i) {
+        request.argv.push_back(std::string(64 * 1024, 'x'));
+    }
+    auto result = executor.Execute(request);
+    EXPECT_TRUE(result.success);
+    EXPECT_EQ(result.output, "4\n");
+    EXPECT_TRUE(executor.UsesServer());
+}
@@ -0,0 +1,77 @@
+#include <gtest/gtest.h>
+#include "ClaudeConsole.h"
+#include "ProcessExecutor.h"
+
+using namespace cll;
+using namespace std::chrono_literals;
+
+class StdinFeedTest : public ::testing::Test {
+protected:
+    CommandResult Feed(const std::string& command, std::string_view input) {
+        auto request = ProcessRequest::Shell(command);
+        request.pipeStdin = true;
+        request.stdinData = input;
+        return executor.Execute(request);
+    }
+
+    ProcessExecutor executor;
+};
+
+// Test data much larger than a pipe arrives intact, NULs and all
+TEST_F(StdinFeedTest, FeedsLargeBinaryInput) {
+    std::string input(8 << 20, '\0');
+    for (size_t i = 0; i < input.size(); ++i) {
+        input[i] = static_cast<char>(i * 7);
+    }
+    auto result = Feed("cat", input);
+    EXPECT_TRUE(result.success);
+    EXPECT_TRUE(result.output == input);
+
+    EXPECT_EQ(Feed("wc -c", input).output, std::to_string(input.size()) + "\n");
+}
+
+// Test a child that stops reading early neither hangs nor kills us
+TEST_F(StdinFeedTest, ReaderStopsEarly) {
+    std::string input(32 << 20, 'x');
+    auto start = std::chrono::steady_clock::now();
+    EXPECT_EQ(Feed("head -c 4", input).output, "xxxx");
+    EXPECT_TRUE(Feed("true", input).success);
+    EXPECT_LT(std::chrono::steady_clock::now() - start, 5s);
+}
+
+// Test the feed syntax is recognised only at the end, outside quotes
+TEST_F(StdinFeedTest, SplitStdinFeed) {
+    std::string rest;
+    ASSERT_TRUE(ClaudeConsole::SplitStdinFeed("wc -l <<< $_", rest));
+    EXPECT_EQ(rest, "wc -l");
+    ASSERT_TRUE(ClaudeConsole::SplitStdinFeed("grep 'a b'<<<$_ ", rest));
+    EXPECT_EQ(rest, "grep 'a b'");
+
+    EXPECT_FALSE(ClaudeConsole::SplitStdinFeed("echo '<<< $_'", rest));
+    EXPECT_FALSE(ClaudeConsole::SplitStdinFeed("wc -l <<< $HOME", rest));
+    EXPECT_FALSE(ClaudeConsole::SplitStdinFeed("<<< $_", rest));
+    EXPECT_FALSE(ClaudeConsole::SplitStdinFeed("wc -l", rest));
+}
+
+// Test the console feeds the previous output, captured or streamed
+TEST_F(StdinFeedTest, ConsoleFeedsPreviousOutput) {
+    ClaudeConsole console;
+    ASSERT_TRUE(console.Initialize());
+
+    console.ExecuteCommand("seq 1 5");
+    EXPECT_EQ(console.ExecuteCommand("wc -l <<< $_").output, "5\n");
+    EXPECT_EQ(console.ExecuteCommand("wc -c <<< $_").output, "2\n");
+
+    std::string streamed;
+    console.SetOutputCallback([&](const std::string& text) { streamed += text; });
+    console.SetStreamingOutput(true);
+    console.ExecuteCommand("seq 3");
+    console.ExecuteCommand("sort -r <<< $_");
+    EXPECT_EQ(streamed, "1\n2\n3\n3\n2\n1\n");
+    console.SetStreamingOutput(false);
+
+    EXPECT_EQ(console.CaptureShellCommand("tr a-z A-Z", "hello").output, "HELLO");
+    // Empty input still closes stdin rather than leaving ours
+    EXPECT_EQ(console.CaptureShellCommand("wc -c", "").output, "0\n");
+    console.Shutdown();
+}